@@ -1,12 +1,19 @@
 #define _CRT_SECURE_NO_WARNINGS
 
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_vulkan.h>
-#include <SDL2/SDL_syswm.h>
+// Command line tools include this file with ANIMATION_TOOL defined to get the animation runtime and the file
+// loading without the window, the renderer or main
+//
+#if !defined(ANIMATION_TOOL)
+    #include <SDL2/SDL.h>
+    #include <SDL2/SDL_vulkan.h>
+    #include <SDL2/SDL_syswm.h>
+
+    #define STBI_ONLY_PNG 1
+    #define STB_IMAGE_IMPLEMENTATION 1
+    #include <stb_image.h>
+#endif
 
-#define STBI_ONLY_PNG 1
-#define STB_IMAGE_IMPLEMENTATION 1
-#include <stb_image.h>
+#include <math.h>
 
 #define CORE_IMPL 1
 #define OS_IMPL   1
@@ -20,16 +27,399 @@
 #include "animation.h"
 #include "render.h"
 
+// Returns data directly when in_place is set and it is suitably aligned, otherwise an aligned copy in the arena
+//
+FileScope void *FileDataGet(Arena *arena, void *data, U64 size, U64 alignment, B32 in_place) {
+    void *result = data;
+
+    if (!in_place || (cast(U64) data & (alignment - 1)) != 0) {
+        result = ArenaPush(arena, U8, size, ARENA_FLAG_NO_ZERO, alignment);
+        MemoryCopy(result, data, size);
+    }
+
+    return result;
+}
+
+// Starts reading an entire file into the arena without blocking the calling thread, the data is aligned so it can
+// always be used in place. once submitted the read is finished with SkeletonFileReadFinish or MeshFileReadFinish,
+// which also close the file
+//
+// if the file can't be opened or the read can't be submitted the read is left in the none state with no file open,
+// finishing it will return false without touching the file
+//
+Func B32 FileReadSubmit(Arena *arena, OS_AsyncQueue *queue, OS_AsyncRead *read, Str8 path) {
+    B32 result = false;
+
+    StructZero(read);
+
+    OS_Handle file = OS_FileOpen(path, OS_FILE_ACCESS_READ);
+    if (file.v != cast(U64) -1) {
+        TempArena temp = TempGet(1, &arena);
+
+        OS_FileInfo info = OS_FileInfoFromHandle(temp.arena, file);
+
+        TempRelease(&temp);
+
+        // the submit fails when max_reads are already in flight, which the caller is expected to retry later, so
+        // the data is popped rather than left in the arena for every attempt
+        //
+        U64 offset = arena->offset;
+
+        read->file = file;
+        read->data = ArenaPush(arena, U8, info.size, ARENA_FLAG_NO_ZERO, 64);
+        read->size = info.size;
+
+        result = OS_AsyncReadSubmit(queue, read);
+        if (!result) {
+            OS_FileClose(file);
+            ArenaPopTo(arena, offset);
+
+            read->file.v = cast(U64) -1;
+            read->data   = 0;
+            read->size   = 0;
+        }
+    }
+
+    return result;
+}
+
+// Waits for the read if it is still pending and returns the data, empty if the read failed
+//
+FileScope Str8 FileReadFinish(OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    Str8 result = { 0 };
+
+    // never submitted, there is no file to close
+    //
+    if (read->state == OS_ASYNC_READ_STATE_NONE) { return result; }
+
+    OS_AsyncReadWait(queue, read);
+    OS_FileClose(read->file);
+
+    if (read->state == OS_ASYNC_READ_STATE_COMPLETE) {
+        result = Str8WrapCount(cast(U8 *) read->data, read->size);
+    }
+
+    return result;
+}
+
+// Quantises an exported vertex to the layout the renderer uses, the cooked vertex formats in the mesh file have
+// exactly the same layout so cooked files can be copied straight into the gpu buffers
+//
+// uvs and normals are clamped to their valid range and rounded to the nearest value, bone weights are renormalised
+// so the quantised weights of each vertex always sum to 255
+//
+// :vertex_cook the batched versions below produce exactly the same output, any change to the quantisation here
+// has to be made there as well
+//
+StaticAssert(sizeof(R_Vertex3)        == sizeof(AMTM_CookedVertex));
+StaticAssert(sizeof(R_SkinnedVertex3) == sizeof(AMTM_CookedSkinnedVertex));
+
+FileScope void VertexCook(R_Vertex3 *to, AMTM_Vertex *from) {
+    to->position.x = from->position[0];
+    to->position.y = from->position[1];
+    to->position.z = from->position[2];
+
+    for (U32 it = 0; it < 2; ++it) {
+        F32 uv = Clamp(0.0f, from->uv[it], 1.0f);
+        to->uv[it] = cast(U16) ((uv * cast(F32) U16_MAX) + 0.5f);
+    }
+
+    for (U32 it = 0; it < 3; ++it) {
+        F32 normal = Clamp(-1.0f, from->normal[it], 1.0f);
+        to->normal[it] = cast(U8) ((normal * 127.0f) + 127.5f);
+    }
+
+    to->normal[3] = 254; // 1.0, unused in shader only for padding
+
+    // @todo: when we start loading multiple meshes materials will be compacted into a
+    // single buffer on the gpu, this means the material_index will have to be re-based to
+    // the current offset in that buffer
+    //
+    // :material_base
+    //
+    to->material_index = from->material_index;
+}
+
+// the skinned vertex starts with the same fields as the static vertex
+//
+FileScope void SkinnedVertexCook(R_SkinnedVertex3 *to, AMTM_SkinnedVertex *from) {
+    VertexCook(&to->vertex, cast(AMTM_Vertex *) from);
+
+    F32 weights[4];
+    for (U32 it = 0; it < 4; ++it) {
+        weights[it] = Max(from->bone_weights[it], 0.0f);
+    }
+
+    F32 sum   = ((weights[0] + weights[1]) + weights[2]) + weights[3];
+    F32 scale = (0.0f < sum) ? (255.0f / sum) : 0.0f;
+
+    for (U32 it = 0; it < 4; ++it) {
+        weights[it] = cast(F32) cast(S32) ((weights[it] * scale) + 0.5f);
+    }
+
+    // any rounding error is given to the largest weight, or the first weight if a vertex has no weights at all
+    //
+    F32 error = 255.0f - (((weights[0] + weights[1]) + weights[2]) + weights[3]);
+
+    U32 largest = 0;
+    for (U32 it = 1; it < 4; ++it) {
+        if (weights[largest] < weights[it]) { largest = it; }
+    }
+
+    weights[largest] += error;
+
+    for (U32 it = 0; it < 4; ++it) {
+        to->bone_indices[it] = from->bone_indices[it];
+        to->bone_weights[it] = cast(U8) weights[it];
+    }
+}
+
+// Quantised fields for WIDE_LANES vertices, one row per field. the values are whole numbers so they convert to the
+// integer vertex fields exactly
+//
+typedef struct VertexLanes VertexLanes;
+struct VertexLanes {
+    F32 uv[2][WIDE_MAX_LANES];
+    F32 normal[3][WIDE_MAX_LANES];
+    F32 weights[4][WIDE_MAX_LANES];
+};
+
+StaticAssert((sizeof(AMTM_Vertex)        % sizeof(F32)) == 0);
+StaticAssert((sizeof(AMTM_SkinnedVertex) % sizeof(F32)) == 0);
+
+// from is the first of WIDE_LANES vertices, stride is the size of each vertex in floats so this can be used for the
+// static and skinned vertex formats
+//
+FileScope void VertexLanesQuantise(VertexLanes *lanes, AMTM_Vertex *from, U32 stride) {
+    WideF32 zero = WideF32Set1(0.0f);
+    WideF32 half = WideF32Set1(0.5f);
+
+    WideF32 uv_min   = zero;
+    WideF32 uv_max   = WideF32Set1(1.0f);
+    WideF32 uv_scale = WideF32Set1(cast(F32) U16_MAX);
+
+    for (U32 it = 0; it < 2; ++it) {
+        WideF32 uv = WideF32LoadStrided(&from->uv[it], stride);
+
+        uv = WideF32Min(WideF32Max(uv, uv_min), uv_max);
+        uv = WideF32Truncate(WideF32Add(WideF32Mul(uv, uv_scale), half));
+
+        WideF32Store(lanes->uv[it], uv);
+    }
+
+    WideF32 normal_min    = WideF32Set1(-1.0f);
+    WideF32 normal_max    = WideF32Set1( 1.0f);
+    WideF32 normal_scale  = WideF32Set1(127.0f);
+    WideF32 normal_offset = WideF32Set1(127.5f);
+
+    for (U32 it = 0; it < 3; ++it) {
+        WideF32 normal = WideF32LoadStrided(&from->normal[it], stride);
+
+        normal = WideF32Min(WideF32Max(normal, normal_min), normal_max);
+        normal = WideF32Truncate(WideF32Add(WideF32Mul(normal, normal_scale), normal_offset));
+
+        WideF32Store(lanes->normal[it], normal);
+    }
+}
+
+FileScope void WeightLanesQuantise(VertexLanes *lanes, AMTM_SkinnedVertex *from) {
+    U32 stride = sizeof(AMTM_SkinnedVertex) / sizeof(F32);
+
+    WideF32 zero = WideF32Set1(0.0f);
+    WideF32 half = WideF32Set1(0.5f);
+    WideF32 max  = WideF32Set1(255.0f);
+
+    WideF32 weights[4];
+    for (U32 it = 0; it < 4; ++it) {
+        weights[it] = WideF32Max(WideF32LoadStrided(&from->bone_weights[it], stride), zero);
+    }
+
+    WideF32 sum   = WideF32Add(WideF32Add(WideF32Add(weights[0], weights[1]), weights[2]), weights[3]);
+    WideF32 scale = WideF32Select(WideF32LessThan(zero, sum), WideF32Div(max, sum), zero);
+
+    for (U32 it = 0; it < 4; ++it) {
+        weights[it] = WideF32Truncate(WideF32Add(WideF32Mul(weights[it], scale), half));
+    }
+
+    WideF32 error = WideF32Sub(max, WideF32Add(WideF32Add(WideF32Add(weights[0], weights[1]), weights[2]), weights[3]));
+
+    // each lane picks its largest weight independently so track which weight is the largest as a mask per weight,
+    // ties go to the earlier weight the same as the scalar version
+    //
+    WideF32 largest   = weights[0];
+    WideF32 chosen[4] = { WideF32MaskFromBits(U32_MAX), zero, zero, zero };
+
+    for (U32 it = 1; it < 4; ++it) {
+        WideF32 mask = WideF32LessThan(largest, weights[it]);
+
+        for (U32 prev = 0; prev < it; ++prev) {
+            chosen[prev] = WideF32Select(mask, zero, chosen[prev]);
+        }
+
+        chosen[it] = mask;
+        largest    = WideF32Select(mask, weights[it], largest);
+    }
+
+    for (U32 it = 0; it < 4; ++it) {
+        weights[it] = WideF32Add(weights[it], WideF32And(chosen[it], error));
+        WideF32Store(lanes->weights[it], weights[it]);
+    }
+}
+
+// Batched versions of VertexCook and SkinnedVertexCook, the uvs, normals and weights are quantised WIDE_LANES
+// vertices at a time. see :vertex_cook
+//
+FileScope void VerticesCook(R_Vertex3 *to, AMTM_Vertex *from, U32 count) {
+    TempArena temp = TempGet(0, 0);
+
+    VertexLanes *lanes = ArenaPush(temp.arena, VertexLanes, 1, ARENA_FLAG_NO_ZERO, WIDE_MAX_LANES * sizeof(F32));
+
+    U32 stride = sizeof(AMTM_Vertex) / sizeof(F32);
+
+    U32 it = 0;
+    for (; (it + WIDE_LANES) <= count; it += WIDE_LANES) {
+        VertexLanesQuantise(lanes, &from[it], stride);
+
+        for (U32 l = 0; l < WIDE_LANES; ++l) {
+            R_Vertex3   *dst = &to[it + l];
+            AMTM_Vertex *src = &from[it + l];
+
+            dst->position.x = src->position[0];
+            dst->position.y = src->position[1];
+            dst->position.z = src->position[2];
+
+            dst->uv[0] = cast(U16) lanes->uv[0][l];
+            dst->uv[1] = cast(U16) lanes->uv[1][l];
+
+            dst->normal[0] = cast(U8) lanes->normal[0][l];
+            dst->normal[1] = cast(U8) lanes->normal[1][l];
+            dst->normal[2] = cast(U8) lanes->normal[2][l];
+            dst->normal[3] = 254;
+
+            dst->material_index = src->material_index;
+        }
+    }
+
+    for (; it < count; ++it) {
+        VertexCook(&to[it], &from[it]);
+    }
+
+    TempRelease(&temp);
+}
+
+FileScope void SkinnedVerticesCook(R_SkinnedVertex3 *to, AMTM_SkinnedVertex *from, U32 count) {
+    TempArena temp = TempGet(0, 0);
+
+    VertexLanes *lanes = ArenaPush(temp.arena, VertexLanes, 1, ARENA_FLAG_NO_ZERO, WIDE_MAX_LANES * sizeof(F32));
+
+    U32 stride = sizeof(AMTM_SkinnedVertex) / sizeof(F32);
+
+    U32 it = 0;
+    for (; (it + WIDE_LANES) <= count; it += WIDE_LANES) {
+        VertexLanesQuantise(lanes, cast(AMTM_Vertex *) &from[it], stride);
+        WeightLanesQuantise(lanes, &from[it]);
+
+        for (U32 l = 0; l < WIDE_LANES; ++l) {
+            R_SkinnedVertex3   *dst = &to[it + l];
+            AMTM_SkinnedVertex *src = &from[it + l];
+
+            dst->vertex.position.x = src->position[0];
+            dst->vertex.position.y = src->position[1];
+            dst->vertex.position.z = src->position[2];
+
+            dst->vertex.uv[0] = cast(U16) lanes->uv[0][l];
+            dst->vertex.uv[1] = cast(U16) lanes->uv[1][l];
+
+            dst->vertex.normal[0] = cast(U8) lanes->normal[0][l];
+            dst->vertex.normal[1] = cast(U8) lanes->normal[1][l];
+            dst->vertex.normal[2] = cast(U8) lanes->normal[2][l];
+            dst->vertex.normal[3] = 254;
+
+            dst->vertex.material_index = src->material_index;
+
+            for (U32 w = 0; w < 4; ++w) {
+                dst->bone_indices[w] = src->bone_indices[w];
+                dst->bone_weights[w] = cast(U8) lanes->weights[w][l];
+            }
+        }
+    }
+
+    for (; it < count; ++it) {
+        SkinnedVertexCook(&to[it], &from[it]);
+    }
+
+    TempRelease(&temp);
+}
+
+#if !defined(ANIMATION_TOOL)
+
 #include "vulkan.h"
 
+typedef struct TextureLoadWork TextureLoadWork;
+struct TextureLoadWork {
+    A_Texture *texture;
+    char      *path;
+};
 
-Func B32 MeshFileLoad(Arena *arena, A_Mesh *mesh, Str8 path) {
+FileScope void TextureLoadWorkRun(void *data) {
+    TextureLoadWork *work = cast(TextureLoadWork *) data;
+
+    // load the image data
+    //
+    int w, h, c;
+    U8 *pixels = stbi_load(work->path, &w, &h, &c, 4);
+
+    Assert(pixels != 0);
+
+    work->texture->width  = w;
+    work->texture->height = h;
+    work->texture->pixels = pixels;
+}
+
+// Converts a range of vertices from a single submesh, only one of the skinned or static pointers is set
+//
+#define VERTEX_COOK_CHUNK_SIZE 16384
+
+typedef struct VertexCookWork VertexCookWork;
+struct VertexCookWork {
+    R_SkinnedVertex3   *skinned_to;
+    AMTM_SkinnedVertex *skinned_from;
+
+    R_Vertex3   *to;
+    AMTM_Vertex *from;
+
+    U32 count;
+};
+
+FileScope void VertexCookWorkRun(void *data) {
+    VertexCookWork *work = cast(VertexCookWork *) data;
+
+    if (work->skinned_to) {
+        SkinnedVerticesCook(work->skinned_to, work->skinned_from, work->count);
+    }
+    else {
+        VerticesCook(work->to, work->from, work->count);
+    }
+}
+
+// When in_place is set the vertex and index blocks of cooked files are referenced directly from data instead of
+// being copied to the arena, so data must stay valid for as long as the mesh is used. uncooked files are always
+// converted into the arena
+//
+FileScope B32 MeshFromData(Arena *arena, A_Mesh *mesh, Str8 data, B32 in_place) {
     B32 result = false;
 
+    if (data.count < cast(S64) sizeof(AMTM_Header)) { return result; }
+
     TempArena temp = TempGet(1, &arena);
 
     AMTM_Mesh amtm = { 0 };
-    AMTM_MeshFromPath(temp.arena, &amtm, path);
+    AMTM_MeshFromData(temp.arena, &amtm, data);
+
+    if (amtm.version < 1 || amtm.version > AMTM_VERSION) {
+        TempRelease(&temp);
+        return result;
+    }
 
     // Copy the string table
     //
@@ -41,15 +431,12 @@ Func B32 MeshFileLoad(Arena *arena, A_Mesh *mesh, Str8 path) {
 
     // Gather submesh information
     //
-    // @todo: for now this just makes a copy of the vertex data and index data and stores it on the
-    // submesh, we should pass in a staging buffer and upload this stuff directly!
+    // the vertex and index data for every submesh is stored in blocks laid out exactly as the gpu buffers expect,
+    // cooked files are already in this layout
     //
-    mesh->submeshes = ArenaPush(arena, A_Submesh, mesh->num_submeshes);
+    B32 cooked = (amtm.version >= 2);
 
-    // running totals for base offsets
-    //
-    U32 total_vertices  = 0;
-    U32 total_indices   = 0;
+    mesh->submeshes = ArenaPush(arena, A_Submesh, mesh->num_submeshes);
 
     for (U32 it = 0; it < mesh->num_submeshes; ++it) {
         A_Submesh    *dst = &mesh->submeshes[it];
@@ -60,89 +447,135 @@ Func B32 MeshFileLoad(Arena *arena, A_Mesh *mesh, Str8 path) {
 
         dst->flags = src->info->flags;
 
-        dst->base_vertex = total_vertices;
-        dst->base_index  = total_indices;
-
         dst->num_vertices = src->info->num_vertices;
         dst->num_indices  = src->info->num_indices;
 
-        dst->indices = ArenaPushCopy(arena, src->indices, U16, dst->num_indices);
+        if (cooked) {
+            dst->base_vertex = src->base_vertex;
+            dst->base_index  = src->base_index;
+        }
+        else {
+            // in submesh order, skinned and static submeshes are in separate vertex blocks as their sizes differ
+            //
+            if (dst->flags & AMTM_MESH_FLAG_IS_SKINNED) {
+                dst->base_vertex            = mesh->num_skinned_vertices;
+                mesh->num_skinned_vertices += dst->num_vertices;
+            }
+            else {
+                dst->base_vertex    = mesh->num_vertices;
+                mesh->num_vertices += dst->num_vertices;
+            }
 
-        // @todo: come up with a more coherent way to copy the vertices, R_SkinnedVertex3 is a the
-        // same as R_Vertex3 but with extra data, this method can be error-prone in the event
-        // the vertex layout changes
-        //
-        if (dst->flags & AMTM_MESH_FLAG_IS_SKINNED) {
-            R_SkinnedVertex3   *to_vertices   = ArenaPush(arena, R_SkinnedVertex3, dst->num_vertices);
-            AMTM_SkinnedVertex *from_vertices = src->skinned_vertices;
+            dst->base_index    = mesh->num_indices;
+            mesh->num_indices += dst->num_indices;
+        }
+    }
+
+    JobCounter counter = { 0 };
+
+    // Gather texture data
+    //
+    // :note we do actually load all textures even though only base colour is used, testing!
+    //
+    mesh->textures = ArenaPush(arena, A_Texture, mesh->num_textures);
+
+    Str8 exe_path = OS_PathGet(temp.arena, OS_PATH_EXECUTABLE);
 
-            for (U32 v = 0; v < dst->num_vertices; ++v) {
-                R_SkinnedVertex3   *to   = &to_vertices[v];
-                AMTM_SkinnedVertex *from = &from_vertices[v];
+    // image decoding is by far the slowest part of loading so each texture is decoded as its own job, these are
+    // pushed first so they run alongside everything else below
+    //
+    TextureLoadWork *texture_work = ArenaPush(temp.arena, TextureLoadWork, mesh->num_textures);
 
-                to->position.x = from->position[0];
-                to->position.y = from->position[1];
-                to->position.z = from->position[2];
+    for (U32 it = 0; it < mesh->num_textures; ++it) {
+        A_Texture    *dst = &mesh->textures[it];
+        AMTM_Texture *src = &amtm.textures[it];
 
-                to->uv[0] = cast(U16) (U16_MAX * from->uv[0]);
-                to->uv[1] = cast(U16) (U16_MAX * from->uv[1]);
+        Str8 name;
+        name.count = src->name_count;
+        name.data  = &mesh->string_table.data[src->name_offset];
 
-                to->normal[0] = cast(U8) ((from->normal[0] * 127.0f) + 127.5f);
-                to->normal[1] = cast(U8) ((from->normal[1] * 127.0f) + 127.5f);
-                to->normal[2] = cast(U8) ((from->normal[2] * 127.0f) + 127.5f);
-                to->normal[3] = 254; // 1.0, unused in shader only for padding
+        dst->name = name;
 
-                // @todo: when we start loading multiple meshes materials will be compacted into a
-                // single buffer on the gpu, this means the material_index will have to be re-based to
-                // the current offset in that buffer
-                //
-                // :material_base
-                //
-                to->material_index = from->material_index;
+        Str8 image_path = Str8Format(temp.arena, Str8Literal("%.*s/textures/%.*s.png"), Str8Arg(exe_path), Str8Arg(name));
 
-                to->bone_indices[0] = from->bone_indices[0];
-                to->bone_indices[1] = from->bone_indices[1];
-                to->bone_indices[2] = from->bone_indices[2];
-                to->bone_indices[3] = from->bone_indices[3];
+        texture_work[it].texture = dst;
+        texture_work[it].path    = Str8PushCopyNullTerminated(temp.arena, image_path);
 
-                to->bone_weights[0] = cast(U8) (U8_MAX * from->bone_weights[0]);
-                to->bone_weights[1] = cast(U8) (U8_MAX * from->bone_weights[1]);
-                to->bone_weights[2] = cast(U8) (U8_MAX * from->bone_weights[2]);
-                to->bone_weights[3] = cast(U8) (U8_MAX * from->bone_weights[3]);
-            }
+        JobPush(TextureLoadWorkRun, &texture_work[it], &counter);
+    }
 
-            dst->vertices = cast(void *) to_vertices;
+    if (cooked) {
+        mesh->num_skinned_vertices = amtm.num_skinned_vertices;
+        mesh->num_vertices         = amtm.num_vertices;
+        mesh->num_indices          = amtm.num_indices;
+
+        U64 skinned_size = mesh->num_skinned_vertices * sizeof(R_SkinnedVertex3);
+        U64 vertex_size  = mesh->num_vertices * sizeof(R_Vertex3);
+        U64 index_size   = mesh->num_indices  * sizeof(U16);
+
+        mesh->skinned_vertices = FileDataGet(arena, amtm.skinned_vertex_data, skinned_size, AMTM_COOKED_ALIGNMENT, in_place);
+        mesh->vertices         = FileDataGet(arena, amtm.vertex_data,         vertex_size,  AMTM_COOKED_ALIGNMENT, in_place);
+        mesh->indices          = FileDataGet(arena, amtm.index_data,          index_size,   AMTM_COOKED_ALIGNMENT, in_place);
+    }
+    else {
+        R_SkinnedVertex3 *skinned_vertices = ArenaPush(arena, R_SkinnedVertex3, mesh->num_skinned_vertices, ARENA_FLAG_NO_ZERO, AMTM_COOKED_ALIGNMENT);
+        R_Vertex3        *vertices         = ArenaPush(arena, R_Vertex3,        mesh->num_vertices,         ARENA_FLAG_NO_ZERO, AMTM_COOKED_ALIGNMENT);
+        U16              *indices          = ArenaPush(arena, U16,              mesh->num_indices,          ARENA_FLAG_NO_ZERO, AMTM_COOKED_ALIGNMENT);
+
+        // each submesh is split into chunks that are converted as separate jobs so large submeshes are spread over
+        // all of the workers, the chunks write to their own range of the blocks so the result doesn't depend on
+        // the order they run in
+        //
+        U32 num_chunks = 0;
+        for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+            num_chunks += (mesh->submeshes[it].num_vertices + (VERTEX_COOK_CHUNK_SIZE - 1)) / VERTEX_COOK_CHUNK_SIZE;
         }
-        else {
-            R_Vertex3   *to_vertices   = ArenaPush(arena, R_Vertex3, dst->num_vertices);
-            AMTM_Vertex *from_vertices = src->vertices;
 
-            for (U32 v = 0; v < dst->num_vertices; ++v) {
-                R_Vertex3   *to   = &to_vertices[v];
-                AMTM_Vertex *from = &from_vertices[v];
+        VertexCookWork *vertex_work = ArenaPush(temp.arena, VertexCookWork, num_chunks);
+        U32 next_chunk = 0;
 
-                to->position.x = from->position[0];
-                to->position.y = from->position[1];
-                to->position.z = from->position[2];
+        for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+            A_Submesh    *dst = &mesh->submeshes[it];
+            AMTM_Submesh *src = &amtm.submeshes[it];
 
-                to->uv[0] = cast(U16) (U16_MAX * from->uv[0]);
-                to->uv[1] = cast(U16) (U16_MAX * from->uv[1]);
+            B32 skinned = (dst->flags & AMTM_MESH_FLAG_IS_SKINNED) != 0;
 
-                to->normal[0] = cast(U8) ((from->normal[0] * 127.0f) + 127.5f);
-                to->normal[1] = cast(U8) ((from->normal[1] * 127.0f) + 127.5f);
-                to->normal[2] = cast(U8) ((from->normal[2] * 127.0f) + 127.5f);
-                to->normal[3] = 254; // 1.0, unused in shader only for padding
+            for (U32 base = 0; base < dst->num_vertices; base += VERTEX_COOK_CHUNK_SIZE) {
+                VertexCookWork *work = &vertex_work[next_chunk++];
 
-                // :material_base
-                //
-                to->material_index = from->material_index;
+                work->count = Min(dst->num_vertices - base, VERTEX_COOK_CHUNK_SIZE);
+
+                if (skinned) {
+                    work->skinned_to   = &skinned_vertices[dst->base_vertex + base];
+                    work->skinned_from = &src->skinned_vertices[base];
+                }
+                else {
+                    work->to   = &vertices[dst->base_vertex + base];
+                    work->from = &src->vertices[base];
+                }
+
+                JobPush(VertexCookWorkRun, work, &counter);
             }
 
-            dst->vertices = cast(void *) to_vertices;
+            MemoryCopy(&indices[dst->base_index], src->indices, dst->num_indices * sizeof(U16));
+        }
+
+        mesh->skinned_vertices = skinned_vertices;
+        mesh->vertices         = vertices;
+        mesh->indices          = indices;
+    }
+
+    for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+        A_Submesh *submesh = &mesh->submeshes[it];
+
+        if (submesh->flags & AMTM_MESH_FLAG_IS_SKINNED) {
+            submesh->vertices = cast(R_SkinnedVertex3 *) mesh->skinned_vertices + submesh->base_vertex;
+        }
+        else {
+            submesh->vertices = cast(R_Vertex3 *) mesh->vertices + submesh->base_vertex;
         }
 
-        total_vertices += dst->num_vertices;
-        total_indices  += dst->num_indices;
+        submesh->indices = cast(U16 *) mesh->indices + submesh->base_index;
     }
 
     // Gather material data
@@ -179,58 +612,66 @@ Func B32 MeshFileLoad(Arena *arena, A_Mesh *mesh, Str8 path) {
         dst->albedo_index = index;
     }
 
-    // Gather texture data
-    //
-    // :note we do actually load all textures even though only base colour is used, testing!
-    //
-    mesh->textures = ArenaPush(arena, A_Texture, mesh->num_textures);
+    JobCounterWait(&counter);
 
-    Str8 exe_path = OS_PathGet(temp.arena, OS_PATH_EXECUTABLE);
+    TempRelease(&temp);
 
-    for (U32 it = 0; it < mesh->num_textures; ++it) {
-        A_Texture    *dst = &mesh->textures[it];
-        AMTM_Texture *src = &amtm.textures[it];
+    result = true;
+    return result;
+}
 
-        Str8 name;
-        name.count = src->name_count;
-        name.data  = &mesh->string_table.data[src->name_offset];
+// The file is mapped rather than read into memory, everything is converted or copied directly from the mapping
+//
+Func B32 MeshFileLoad(Arena *arena, A_Mesh *mesh, Str8 path) {
+    OS_FileMapping mapping = OS_FileMap(path);
 
-        dst->name = name;
+    B32 result = MeshFromData(arena, mesh, mapping.data, false);
 
-        Str8 image_path = Str8Format(temp.arena, Str8Literal("%.*s/textures/%.*s.png"), Str8Arg(exe_path), Str8Arg(name));
+    OS_FileUnmap(&mapping);
 
-        // load the image data
-        //
-        int w, h, c;
-        U8 *pixels = stbi_load(Str8PushCopyNullTerminated(temp.arena, image_path), &w, &h, &c, 4);
+    return result;
+}
 
-        Assert(pixels != 0);
+// Zero-copy version of MeshFileLoad for cooked files, the vertex and index blocks are used directly from the mapping
+// so they can be copied straight into the gpu buffers. the file must stay mapped for as long as the mesh is used
+//
+Func B32 MeshFileMap(Arena *arena, A_Mesh *mesh, OS_FileMapping *mapping, Str8 path) {
+    *mapping = OS_FileMap(path);
 
-        dst->width  = w;
-        dst->height = h;
-        dst->pixels = pixels;
-    }
+    B32 result = MeshFromData(arena, mesh, mapping->data, true);
+    if (!result) { OS_FileUnmap(mapping); }
 
-    TempRelease(&temp);
+    return result;
+}
 
-    result = true;
+// The data was read into the arena by FileReadSubmit so the vertex and index blocks of cooked files are used in place
+//
+Func B32 MeshFileReadFinish(Arena *arena, A_Mesh *mesh, OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    Str8 data = FileReadFinish(queue, read);
+
+    B32 result = MeshFromData(arena, mesh, data, true);
     return result;
 }
 
-Func B32 SkeletonFileLoad(Arena *arena, A_Skeleton *skeleton, Str8 path) {
+#endif
+
+// When in_place is set the string table, samples and clip data are referenced directly from data instead of being
+// copied to the arena, so data must stay valid for as long as the skeleton is used
+//
+FileScope B32 SkeletonFromData(Arena *arena, A_Skeleton *skeleton, Str8 data, B32 in_place) {
     B32 result = false;
 
-    TempArena temp = TempGet(1, &arena);
+    if (data.count < cast(S64) sizeof(AMTS_Header)) { return result; }
 
     AMTS_Skeleton amts = { 0 };
-    AMTS_SkeletonFromPath(temp.arena, &amts, path);
+    AMTS_SkeletonFromData(&amts, data);
 
-    if (amts.version == AMTS_VERSION) {
+    if (amts.version >= 1 && amts.version <= AMTS_VERSION) {
         // we have a version we recognise
         //
         Str8 string_table;
         string_table.count = amts.string_table.count;
-        string_table.data  = ArenaPushCopy(arena, amts.string_table.data, U8, string_table.count);
+        string_table.data  = cast(U8 *) FileDataGet(arena, amts.string_table.data, string_table.count, 1, in_place);
 
         skeleton->string_table = string_table;
         skeleton->framerate    = amts.framerate;
@@ -251,37 +692,242 @@ Func B32 SkeletonFileLoad(Arena *arena, A_Skeleton *skeleton, Str8 path) {
             dst->name.count = src->name_count;
             dst->name.data  = &string_table.data[src->name_offset];
 
-            A_Sample inv_bind_pose;
+            MemoryCopy(&dst->bind_pose, &src->bind_pose, sizeof(AMTS_Sample));
 
-            MemoryCopy(&dst->bind_pose, &src->bind_pose,     sizeof(AMTS_Sample));
-            MemoryCopy(&inv_bind_pose,  &src->inv_bind_pose, sizeof(AMTS_Sample));
-
-            dst->inv_bind_pose = A_SampleToM4x4F(&inv_bind_pose);
+            // the inverse bind pose in the file is decomposed into a sample, which can't represent the inverse of a
+            // bind pose with non-uniform scale, so the full affine inverse is used instead
+            //
+            dst->inv_bind_pose = M3x4FInverse(A_SampleToM3x4F(&dst->bind_pose));
         }
 
-        A_Sample *samples = ArenaPushCopy(arena, amts.samples, A_Sample, amts.total_samples);
-
         skeleton->animations = ArenaPush(arena, A_Animation, skeleton->num_animations);
-        for (U32 it = 0; it < skeleton->num_animations; ++it) {
-            AMTS_TrackInfo *track     = &amts.tracks[it];
-            A_Animation    *animation = &skeleton->animations[it];
 
-            animation->name.count = track->name_count;
-            animation->name.data  = &string_table.data[track->name_offset];
+        if (amts.version == 1) {
+            // uncompressed, every channel is stored in full for every frame
+            //
+            A_Sample *samples = cast(A_Sample *) FileDataGet(arena, amts.samples, amts.total_samples * sizeof(A_Sample), 4, in_place);
 
-            animation->time       = 0;
-            animation->time_scale = 1;
+            for (U32 it = 0; it < skeleton->num_animations; ++it) {
+                AMTS_TrackInfo *track     = &amts.tracks[it];
+                A_Animation    *animation = &skeleton->animations[it];
 
-            animation->num_frames = track->num_frames;
-            animation->samples    = samples;
+                animation->name.count = track->name_count;
+                animation->name.data  = &string_table.data[track->name_offset];
 
-            samples += (animation->num_frames * skeleton->num_bones);
-        }
+                A_AnimationFromSamples(arena, animation, skeleton->num_bones, track->num_frames, samples);
+
+                samples += (animation->num_frames * skeleton->num_bones);
+            }
+        }
+        else {
+            // the compressed clip data is used as-is, only the channel offsets are calculated here
+            //
+            StaticAssert(cast(U32) AMTS_CHANNEL_FORMAT_IDENTITY  == cast(U32) A_CHANNEL_FORMAT_IDENTITY);
+            StaticAssert(cast(U32) AMTS_CHANNEL_FORMAT_CONSTANT  == cast(U32) A_CHANNEL_FORMAT_CONSTANT);
+            StaticAssert(cast(U32) AMTS_CHANNEL_FORMAT_QUANTISED == cast(U32) A_CHANNEL_FORMAT_QUANTISED);
+            StaticAssert(cast(U32) AMTS_CHANNEL_FORMAT_SPARSE    == cast(U32) A_CHANNEL_FORMAT_SPARSE);
+            StaticAssert(cast(U32) AMTS_CHANNEL_FORMAT_CURVE     == cast(U32) A_CHANNEL_FORMAT_CURVE);
+
+            U8 *clip_data = cast(U8 *) FileDataGet(arena, amts.clip_data, amts.clip_data_size, 16, in_place);
+
+            // versions before 4 only had 2 bits per channel format
+            //
+            U32 format_bits  = (amts.version >= 4) ? AMTS_CHANNEL_FORMAT_BITS : AMTS_CHANNEL_FORMAT_BITS_V2;
+            U32 format_mask  = (1 << format_bits) - 1;
+            U32 formats_size = (amts.version >= 4) ? AlignUp(2 * skeleton->num_bones, 4) : AlignUp(skeleton->num_bones, 4);
+
+            for (U32 it = 0; it < skeleton->num_animations; ++it) {
+                AMTS_TrackInfo *track     = &amts.tracks[it];
+                AMTS_ClipInfo  *clip      = &amts.clips[it];
+                A_Animation    *animation = &skeleton->animations[it];
+
+                animation->name.count = track->name_count;
+                animation->name.data  = &string_table.data[track->name_offset];
+
+                animation->num_frames = track->num_frames;
+                animation->channels   = ArenaPush(arena, A_Channel, skeleton->num_bones * A_CHANNEL_TYPE_COUNT);
+
+                U8 *formats = clip_data + clip->data_offset;
+
+                U32 num_constants  = 0;
+                U32 num_components = 0;
+                U32 frame_stride   = 0;
+
+                for (U32 bone = 0; bone < skeleton->num_bones; ++bone) {
+                    U32 bone_formats = (amts.version >= 4) ? (cast(U16 *) formats)[bone] : formats[bone];
+
+                    for (U32 type = 0; type < A_CHANNEL_TYPE_COUNT; ++type) {
+                        A_Channel *channel = &animation->channels[(bone * A_CHANNEL_TYPE_COUNT) + type];
+
+                        U32 count = (type == A_CHANNEL_TYPE_ORIENTATION) ? 4 : 3;
+
+                        channel->format = (bone_formats >> (type * format_bits)) & format_mask;
+                        channel->offset = 0;
+
+                        if (channel->format == A_CHANNEL_FORMAT_CONSTANT) {
+                            channel->offset = num_constants;
+                            num_constants  += count;
+                        }
+                        else if (channel->format == A_CHANNEL_FORMAT_QUANTISED) {
+                            channel->offset = frame_stride;
+                            frame_stride   += (3 * sizeof(U16));
+                        }
+                        else if (channel->format == A_CHANNEL_FORMAT_CURVE) {
+                            channel->offset = num_components;
+                            num_components += count;
+                        }
+                    }
+                }
+
+                animation->constants    = cast(F32 *) (formats + formats_size);
+                animation->frames       = cast(U8 *) (animation->constants + num_constants);
+                animation->frame_stride = frame_stride;
+                animation->keys         = animation->frames + (cast(U64) frame_stride * track->num_frames);
+
+                // sparse channels are variable length so their offsets can only be found by walking them
+                //
+                U32 keys_offset = 0;
+
+                for (U32 c = 0; c < skeleton->num_bones * A_CHANNEL_TYPE_COUNT; ++c) {
+                    A_Channel *channel = &animation->channels[c];
+
+                    if (channel->format == A_CHANNEL_FORMAT_SPARSE) {
+                        U16 num_keys = *cast(U16 *) (animation->keys + keys_offset);
+
+                        Assert(num_keys != 0);
+
+                        channel->offset = keys_offset;
+                        keys_offset    += (2 * sizeof(U16)) + (num_keys * sizeof(U16)) + (3 * num_keys * sizeof(U16));
+                    }
+                }
+
+                if (num_components != 0) {
+                    // the curve values are copied out so they can be padded and aligned for the wide kernels
+                    //
+                    U8 *curve_data = animation->keys + AlignUp(keys_offset, 4);
+
+                    U32 num_knots = *cast(U32 *) curve_data;
+                    U16 *knots    = cast(U16 *) (curve_data + sizeof(U32));
+                    F32 *values   = cast(F32 *) (knots + AlignUp(num_knots, 2));
+
+                    Assert(num_knots != 0);
+
+                    U32 stride    = cast(U32) AlignUp(num_components, WIDE_MAX_LANES);
+                    U32 alignment = WIDE_MAX_LANES * sizeof(F32);
+
+                    animation->num_knots    = num_knots;
+                    animation->curve_stride = stride;
+                    animation->knot_frames  = knots;
+                    animation->curves       = ArenaPush(arena, F32, 2 * stride * num_knots, 0, alignment);
+
+                    for (U32 k = 0; k < 2 * num_knots; ++k) {
+                        MemoryCopy(&animation->curves[k * stride], &values[k * num_components], num_components * sizeof(F32));
+                    }
+
+                    Assert(cast(U8 *) (values + (2 * num_knots * num_components)) <= (formats + clip->data_size));
+                }
+                else {
+                    Assert((animation->keys + keys_offset) <= (formats + clip->data_size));
+                }
+
+                F32 *pmin = clip->position_min;
+                F32 *pext = clip->position_extent;
+                F32 *smin = clip->scale_min;
+                F32 *sext = clip->scale_extent;
+
+                animation->position_min  = V3F(pmin[0], pmin[1], pmin[2]);
+                animation->position_step = V3F(pext[0] / U16_MAX, pext[1] / U16_MAX, pext[2] / U16_MAX);
+                animation->scale_min     = V3F(smin[0], smin[1], smin[2]);
+                animation->scale_step    = V3F(sext[0] / U16_MAX, sext[1] / U16_MAX, sext[2] / U16_MAX);
+            }
+        }
+
+        // the exporter has already calculated the differences for additive clips, the reference is only recorded
+        // so the clip can't be mistaken for a full pose
+        //
+        for (U32 it = 0; it < skeleton->num_animations; ++it) {
+            AMTS_TrackInfo *track     = &amts.tracks[it];
+            A_Animation    *animation = &skeleton->animations[it];
+
+            if (track->flags & AMTS_TRACK_FLAG_ADDITIVE) {
+                B32 bind_pose = (track->flags & AMTS_TRACK_FLAG_ADDITIVE_BIND_POSE) != 0;
+                animation->additive = bind_pose ? A_ADDITIVE_REFERENCE_BIND_POSE : A_ADDITIVE_REFERENCE_FIRST_FRAME;
+            }
+            else {
+                animation->additive = A_ADDITIVE_REFERENCE_NONE;
+            }
+        }
+
+        result = true;
     }
 
-    TempRelease(&temp);
+    return result;
+}
+
+// The file is mapped rather than read into memory so only the converted skeleton is ever allocated
+//
+Func B32 SkeletonFileLoad(Arena *arena, A_Skeleton *skeleton, Str8 path) {
+    OS_FileMapping mapping = OS_FileMap(path);
+
+    B32 result = SkeletonFromData(arena, skeleton, mapping.data, false);
+
+    OS_FileUnmap(&mapping);
+
+    return result;
+}
+
+// Zero-copy version of SkeletonFileLoad, the clip data is used directly from the mapping so the file must stay
+// mapped for as long as the skeleton is used. files written by older exporters may not have their clip data aligned,
+// in which case it is copied
+//
+Func B32 SkeletonFileMap(Arena *arena, A_Skeleton *skeleton, OS_FileMapping *mapping, Str8 path) {
+    *mapping = OS_FileMap(path);
+
+    B32 result = SkeletonFromData(arena, skeleton, mapping->data, true);
+    if (!result) { OS_FileUnmap(mapping); }
+
+    return result;
+}
+
+Func B32 SkeletonFileReadFinish(Arena *arena, A_Skeleton *skeleton, OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    Str8 data = FileReadFinish(queue, read);
+
+    B32 result = SkeletonFromData(arena, skeleton, data, true);
+    return result;
+}
+
+// The matrix data is used in place, the clip info is converted
+//
+Func B32 BakedFileLoad(Arena *arena, A_BakedClips *baked, Str8 path) {
+    B32 result = false;
+
+    AMTB_Baked amtb = { 0 };
+    AMTB_BakedFromPath(arena, &amtb, path);
+
+    if (amtb.version >= 1 && amtb.version <= AMTB_VERSION) {
+        baked->flags     = (amtb.flags & AMTB_FLAG_HALF) ? A_BAKE_FLAG_HALF : 0;
+        baked->framerate = amtb.framerate;
+
+        baked->num_bones    = amtb.num_bones;
+        baked->num_clips    = amtb.num_clips;
+        baked->total_frames = amtb.total_frames;
+
+        baked->matrix_size  = AMTB_MatrixSizeGet(amtb.flags);
+        baked->frame_stride = cast(U64) baked->num_bones * baked->matrix_size;
+
+        baked->clips = ArenaPush(arena, A_BakedClip, baked->num_clips);
+
+        for (U32 it = 0; it < baked->num_clips; ++it) {
+            baked->clips[it].first_frame = amtb.clips[it].first_frame;
+            baked->clips[it].num_frames  = amtb.clips[it].num_frames;
+        }
+
+        baked->size = amtb.data_size;
+        baked->data = amtb.data;
+
+        result = true;
+    }
 
-    result = true;
     return result;
 }
 
@@ -340,6 +986,8 @@ static F64 F64ElapsedTimeGet(U64 start, U64 end) {
 }
 #endif
 
+#if !defined(ANIMATION_TOOL)
+
 #if OS_WINDOWS
 int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     (void) hInstance;
@@ -376,18 +1024,31 @@ int main(int argc, char **argv) {
     //
     Arena *arena = ArenaAlloc(GB(64));
 
+    // start worker threads, one per core excluding the main thread
+    //
+    JobSystemInit(arena, 0);
+
     // Load Mesh
     //
+    // cooked meshes are copied straight from the file mapping into the gpu buffers, so it is kept for the lifetime
+    // of the program
+    //
+    OS_FileMapping mesh_mapping = {};
+
     A_Mesh mesh = {};
-    if (!MeshFileLoad(arena, &mesh, mesh_path)) {
+    if (!MeshFileMap(arena, &mesh, &mesh_mapping, mesh_path)) {
         printf("[error] :: failed to load mesh\n");
         return 1;
     }
 
     // Load Skeleton
     //
+    // the skeleton is used for the lifetime of the program so its clip data is used directly from the file mapping
+    //
+    OS_FileMapping skel_mapping = {};
+
     A_Skeleton skeleton = {};
-    if (!SkeletonFileLoad(arena, &skeleton, skel_path)) {
+    if (!SkeletonFileMap(arena, &skeleton, &skel_mapping, skel_path)) {
         printf("[error] :: failed to load skeleton\n");
         return 1;
     }
@@ -399,7 +1060,22 @@ int main(int argc, char **argv) {
     printf("\nAnimations:\n");
     for (U32 it = 0; it < skeleton.num_animations; ++it) {
         A_Animation *animation = &skeleton.animations[it];
-        printf("  [%d]: %.*s\t(%d frames)\n", it, (U32) animation->name.count, animation->name.data, animation->num_frames);
+        printf("  [%d]: %.*s\t(%d frames", it, (U32) animation->name.count, animation->name.data, animation->num_frames);
+
+        if (animation->num_knots != 0) {
+            printf(", %d curve knots", animation->num_knots);
+        }
+
+        printf(")\n");
+    }
+
+    // bone lods for when the camera is far away from the character
+    //
+    A_SkeletonLodsBuild(arena, &skeleton, &mesh, 4);
+
+    printf("\nBone LODs:\n");
+    for (U32 it = 0; it < skeleton.num_lods; ++it) {
+        printf("  [%d]: %d bones\n", it, skeleton.lods[it].num_kept);
     }
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -518,34 +1194,14 @@ int main(int argc, char **argv) {
     VK_BufferCreate(device, &vb);
     VK_BufferCreate(device, &ib);
 
-    {
-        R_SkinnedVertex3 *vertices = cast(R_SkinnedVertex3 *) vb.data;
-        U16 *indices = cast(U16 *) ib.data;
-
-        U32 base_vertex = 0;
-        U32 base_index  = 0;
-
-        for (U32 it = 0; it < mesh.num_submeshes; ++it) {
-            A_Submesh *submesh = &mesh.submeshes[it];
-
-            if (!(submesh->flags & AMTM_MESH_FLAG_IS_SKINNED)) { continue; }
-
-            MemoryCopy(vertices, submesh->vertices, submesh->num_vertices * sizeof(R_SkinnedVertex3));
-            MemoryCopy(indices,  submesh->indices,  submesh->num_indices  * sizeof(U16));
-
-            vertices += submesh->num_vertices;
-            indices  += submesh->num_indices;
-
-            submesh->base_vertex = base_vertex;
-            submesh->base_index  = base_index;
-
-            base_vertex += submesh->num_vertices;
-            base_index  += submesh->num_indices;
-        }
-    }
+    // the mesh data is already laid out as the shaders expect so it can be copied in one go, only skinned submeshes
+    // are drawn
+    //
+    MemoryCopy(vb.data, mesh.skinned_vertices, mesh.num_skinned_vertices * sizeof(R_SkinnedVertex3));
+    MemoryCopy(ib.data, mesh.indices,          mesh.num_indices * sizeof(U16));
 
     VK_Buffer bb = {};
-    bb.size        = skeleton.num_bones * sizeof(Mat4x4F);
+    bb.size        = skeleton.num_bones * sizeof(Mat3x4F);
     bb.host_mapped = true;
     bb.usage       = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 
@@ -609,7 +1265,12 @@ int main(int argc, char **argv) {
     F32 pitch = 0, yaw = 0;
 
     U32 index = 0;
-    U32 animation_index = 0;
+
+    // the clip data on the skeleton is shared, all of the playback state is stored here. the controller owns the
+    // playback so switching clips can be blended
+    //
+    A_Controller controller = A_ControllerCreate(arena, &skeleton, 0, A_LOOP_MODE_REPEAT);
+    A_Pose       pose       = A_PosePush(arena, skeleton.num_bones);
 
     // for timing
     F32 delta_time = 0;
@@ -632,26 +1293,34 @@ int main(int argc, char **argv) {
                     case SDLK_ESCAPE: { SDL_SetRelativeMouseMode(SDL_FALSE); } break;
                     case SDLK_f: {
                         index += 1;
-                        if (index >= skeleton.animations[animation_index].num_frames) {
+                        if (index >= skeleton.animations[controller.target.animation_index].num_frames) {
                             index = 0;
                         }
                     }
                     break;
                     case SDLK_n: {
-                        animation_index += 1;
-                        index = 0;
+                        U32 next = controller.target.animation_index + 1;
+                        if (next >= skeleton.num_animations) {
+                            next = 0;
+                        }
 
-                        if (animation_index >= skeleton.num_animations) {
-                            animation_index = 0;
+                        // holding left control inertializes instead of cross fading
+                        //
+                        A_TransitionFlags flags = 0;
+                        if (e.key.keysym.mod & KMOD_LCTRL) {
+                            flags |= A_TRANSITION_FLAG_INERTIALIZE;
                         }
+
+                        A_ControllerTransition(&controller, next, A_LOOP_MODE_REPEAT, 0.3f, A_TRANSITION_CURVE_EASE, flags);
+                        index = 0;
                     }
                     break;
                     case SDLK_t: {
                         if (e.key.keysym.mod & KMOD_LCTRL) {
-                            skeleton.animations[animation_index].time_scale *= 0.5f;
+                            controller.target.time_scale *= 0.5f;
                         }
                         else {
-                            skeleton.animations[animation_index].time_scale *= 2.0f;
+                            controller.target.time_scale *= 2.0f;
                         }
                     }
                     break;
@@ -755,20 +1424,21 @@ int main(int argc, char **argv) {
 
         // Prepare animation ....
         //
-        TempArena temp;
-        DeferLoop(temp = TempGet(0, 0), TempRelease(&temp)) {
-            // @todo: would love to calculate these directly into the mapped buffer, however,
-            // mapped gpu memory may be in write-combined memory and you _really_ don't want
-            // to be reading from that. as the calculations require lookups of the parent samples
-            // this is a no go
+        {
+            // the character is at the origin, each bone lod level is used from twice the distance of the level
+            // before it
             //
-            Mat4x4F  *bone_matrices = ArenaPush(temp.arena, Mat4x4F,  skeleton.num_bones);
-            A_Sample *samples       = ArenaPush(temp.arena, A_Sample, skeleton.num_bones);
+            F32 distance = F32Sqrt(V3FDot(p, p));
+
+            U32 lod = 0;
+            for (F32 d = 8.0f; distance > d && lod < skeleton.num_lods; d *= 2.0f) { lod += 1; }
 
-            A_AnimationEvaluate(samples, &skeleton, animation_index, delta_time);
-            A_AnimationBoneMatricesGet(bone_matrices, &skeleton, samples);
+            A_ControllerEvaluate(&pose, &controller, delta_time, 0);
 
-            MemoryCopy(bb.data, bone_matrices, skeleton.num_bones * sizeof(Mat4x4F));
+            // mapped gpu memory may be write-combined so it must never be read, the hierarchy is solved in temporary
+            // memory and only the final palette is streamed into the mapped buffer
+            //
+            A_PoseBoneMatricesStream(cast(Mat3x4F *) bb.data, &skeleton, &pose, 0, lod);
         }
 
         VkCommandBuffer cmds = VK_CommandBufferPush(vk, frame);
@@ -1036,30 +1706,17 @@ int main(int argc, char **argv) {
         start = end;
     }
 
+    JobSystemShutdown();
+
     return 0;
 }
 
+#endif  // !ANIMATION_TOOL
+
 // animation.c
 //
-Mat4x4F A_SampleToM4x4F(A_Sample *sample) {
-    // @speed: simd?
-    //
-    Mat4x4F result = Q4FToM4x4F(sample->orientation);
-
-    result.m[0][0] *= sample->scale.x;
-    result.m[0][1] *= sample->scale.x;
-    result.m[0][2] *= sample->scale.x;
-
-    result.m[1][0] *= sample->scale.y;
-    result.m[1][1] *= sample->scale.y;
-    result.m[1][2] *= sample->scale.y;
-
-    result.m[2][0] *= sample->scale.z;
-    result.m[2][1] *= sample->scale.z;
-    result.m[1][2] *= sample->scale.z;
-
-    result = M4x4FTranslateV3F(result, sample->position);
-
+Mat3x4F A_SampleToM3x4F(A_Sample *sample) {
+    Mat3x4F result = T3FToM3x4F(*sample);
     return result;
 }
 
@@ -1084,71 +1741,2993 @@ A_Sample A_SampleLerp(A_Sample *a, A_Sample *b, F32 t) {
     return result;
 }
 
-A_Sample *A_AnimationSamplesForFrame(A_Animation *animation, U32 num_bones, U32 frame_index) {
-    A_Sample *result = &animation->samples[num_bones * frame_index];
+void A_AnimationFromSamples(Arena *arena, A_Animation *animation, U32 num_bones, U32 num_frames, A_Sample *samples) {
+    animation->num_frames   = num_frames;
+    animation->frame_stride = num_bones * sizeof(A_Sample);
+    animation->additive     = A_ADDITIVE_REFERENCE_NONE;
+
+    animation->frames    = cast(U8 *) samples;
+    animation->keys      = 0;
+    animation->constants = 0;
+
+    animation->num_knots    = 0;
+    animation->curve_stride = 0;
+    animation->knot_frames  = 0;
+    animation->curves       = 0;
+
+    animation->channels = ArenaPush(arena, A_Channel, num_bones * A_CHANNEL_TYPE_COUNT);
+
+    for (U32 it = 0; it < num_bones; ++it) {
+        A_Channel *channels = &animation->channels[it * A_CHANNEL_TYPE_COUNT];
+        U32 base = it * sizeof(A_Sample);
+
+        channels[A_CHANNEL_TYPE_POSITION].format    = A_CHANNEL_FORMAT_RAW;
+        channels[A_CHANNEL_TYPE_POSITION].offset    = base;
+        channels[A_CHANNEL_TYPE_ORIENTATION].format = A_CHANNEL_FORMAT_RAW;
+        channels[A_CHANNEL_TYPE_ORIENTATION].offset = base + sizeof(Vec3F);
+        channels[A_CHANNEL_TYPE_SCALE].format       = A_CHANNEL_FORMAT_RAW;
+        channels[A_CHANNEL_TYPE_SCALE].offset       = base + sizeof(Vec3F) + sizeof(Quat4F);
+    }
+
+    animation->position_min  = V3F(0, 0, 0);
+    animation->position_step = V3F(0, 0, 0);
+    animation->scale_min     = V3F(0, 0, 0);
+    animation->scale_step    = V3F(0, 0, 0);
+}
+
+// The skeleton stores bind poses in model space, additive references need them relative to the parent
+//
+FileScope A_Sample A_BoneLocalBindPoseGet(A_Skeleton *skeleton, U32 bone_index) {
+    A_Bone  *bone   = &skeleton->bones[bone_index];
+    A_Sample result = bone->bind_pose;
+
+    if (bone->parent_index != 0xFF) {
+        A_Sample *parent = &skeleton->bones[bone->parent_index].bind_pose;
+
+        Quat4F inv_orientation = Q4FConjugate(parent->orientation);
+        Vec3F  inv_scale       = V3F(1.0f / parent->scale.x, 1.0f / parent->scale.y, 1.0f / parent->scale.z);
+
+        // rotate the offset from the parent into the space of the parent, (conjugate(q) * v * q)
+        //
+        Quat4F offset;
+        offset.w   = 0;
+        offset.xyz = V3FAdd(bone->bind_pose.position, V3FNeg(parent->position));
+        offset     = Q4FMul(Q4FMul(inv_orientation, offset), parent->orientation);
+
+        result.position    = V3FHadamard(offset.xyz, inv_scale);
+        result.orientation = Q4FNormalize(Q4FMul(inv_orientation, bone->bind_pose.orientation));
+        result.scale       = V3FHadamard(bone->bind_pose.scale, inv_scale);
+    }
+
+    return result;
+}
+
+// The inverse of what A_PoseAdditive applies, see A_AnimationAdditiveMake
+//
+FileScope A_Sample A_SampleDifferenceGet(A_Sample *reference, A_Sample *sample) {
+    A_Sample result;
+
+    Vec3F inv_scale = V3F(1.0f / reference->scale.x, 1.0f / reference->scale.y, 1.0f / reference->scale.z);
+
+    result.position    = V3FAdd(sample->position, V3FNeg(reference->position));
+    result.orientation = Q4FNormalize(Q4FMul(Q4FConjugate(reference->orientation), sample->orientation));
+    result.scale       = V3FHadamard(sample->scale, inv_scale);
+
     return result;
 }
 
-void A_AnimationEvaluate(A_Sample *output_samples, A_Skeleton *skeleton, U32 animation_index, F32 dt) {
+void A_AnimationAdditiveMake(Arena *arena, A_Skeleton *skeleton, U32 animation_index, A_AdditiveReference reference) {
     Assert(animation_index < skeleton->num_animations);
+    Assert(reference != A_ADDITIVE_REFERENCE_NONE);
 
     A_Animation *animation = &skeleton->animations[animation_index];
+    Assert(animation->additive == A_ADDITIVE_REFERENCE_NONE);
 
-    F32 framerate     = cast(F32) skeleton->framerate;
-    F32 inv_framerate = 1.0f / framerate;
+    U32 num_bones  = skeleton->num_bones;
+    U32 num_frames = animation->num_frames;
 
-    F32 total_time   = inv_framerate * animation->num_frames;
-    animation->time += (animation->time_scale * dt);
+    A_Sample *samples = ArenaPush(arena, A_Sample, num_frames * num_bones, ARENA_FLAG_NO_ZERO);
 
-    if (animation->time >= total_time) {
-        animation->time -= cast(U32) (animation->time / total_time) * total_time;
+    for (U32 it = 0; it < num_frames; ++it) {
+        A_AnimationFrameDecode(&samples[it * num_bones], animation, num_bones, it, 0);
     }
 
-    // @todo: might want to have a flag on the animations to see whether it loops or should stop on the
-    // final frame
-    //
-    U32 frame_index0 = (U32) ((animation->time / total_time) * animation->num_frames);
-    U32 frame_index1 = (frame_index0 + 1) % animation->num_frames;
+    TempArena temp = TempGet(1, &arena);
 
-    // @todo: is this t calculation correct?
-    //
-    F32 t = (animation->time - (inv_framerate * frame_index0)) * framerate;
+    A_Sample *references = ArenaPush(temp.arena, A_Sample, num_bones, ARENA_FLAG_NO_ZERO);
+
+    for (U32 it = 0; it < num_bones; ++it) {
+        if (reference == A_ADDITIVE_REFERENCE_FIRST_FRAME) {
+            references[it] = samples[it];
+        }
+        else {
+            references[it] = A_BoneLocalBindPoseGet(skeleton, it);
+        }
+    }
 
-    A_Sample *frame0 = A_AnimationSamplesForFrame(animation, skeleton->num_bones, frame_index0);
-    A_Sample *frame1 = A_AnimationSamplesForFrame(animation, skeleton->num_bones, frame_index1);
+    for (U32 f = 0; f < num_frames; ++f) {
+        A_Sample *frame = &samples[f * num_bones];
 
-    for (U32 it = 0; it < skeleton->num_bones; ++it) {
-        output_samples[it] = A_SampleLerp(&frame0[it], &frame1[it], t);
+        for (U32 it = 0; it < num_bones; ++it) {
+            frame[it] = A_SampleDifferenceGet(&references[it], &frame[it]);
+        }
     }
+
+    TempRelease(&temp);
+
+    A_AnimationFromSamples(arena, animation, num_bones, num_frames, samples);
+    animation->additive = reference;
 }
 
-void A_AnimationBoneMatricesGet(Mat4x4F *output_matrices, A_Skeleton *skeleton, A_Sample *samples) {
-    for (U32 it = 0; it < skeleton->num_bones; ++it) {
-        A_Bone *bone = &skeleton->bones[it];
+// The two frames to interpolate between, and the amount to interpolate by, for a given time
+//
+typedef struct A_FramePair A_FramePair;
+struct A_FramePair {
+    U32 index0;
+    U32 index1;
+    F32 t;
+};
 
-        if (bone->parent_index == 0xFF) {
-            // root bone
-            //
-            output_matrices[it] = A_SampleToM4x4F(&samples[it]);
-        }
-        else {
-            Assert(bone->parent_index < it);
+A_Cursor *A_CursorPush(Arena *arena, A_Skeleton *skeleton) {
+    A_Cursor *result = ArenaPush(arena, A_Cursor);
 
-            Mat4x4F transform   = A_SampleToM4x4F(&samples[it]);
-            output_matrices[it] = M4x4FMul(output_matrices[bone->parent_index], transform);
-        }
+    result->animation    = 0;
+    result->num_channels = skeleton->num_bones * A_CHANNEL_TYPE_COUNT;
+    result->keys         = ArenaPush(arena, U16, result->num_channels);
+
+    return result;
+}
+
+// Returns the last key at or before frame_index. if a cursor key is provided, it is used as the starting point
+// and updated with the key found
+//
+// the cursor only steps forward a few keys, a fresh or reset cursor is at key zero so seeking into the middle of
+// a clip falls back to a binary search over the keys after the cursor rather than walking all of them
+//
+FileScope U32 A_SparseKeyFind(U16 *key_frames, U32 num_keys, U32 frame_index, U16 *cursor_key) {
+    U32 result = cursor_key ? *cursor_key : num_keys;
+
+    U32 lo = 0;
+    U32 hi = num_keys - 1;
+
+    if (result < num_keys && key_frames[result] <= frame_index) {
+        // moving forward, generally this will only step zero or one keys
+        //
+        U32 max_steps = 4;
+        U32 limit     = Min(result + max_steps, hi);
+
+        lo = result;
+        while (lo < limit && key_frames[lo + 1] <= frame_index) { lo += 1; }
+
+        // stopped before the limit so the next key is after frame_index
+        //
+        if (lo < limit) { hi = lo; }
+    }
+
+    while (lo < hi) {
+        U32 mid = (lo + hi + 1) >> 1;
+
+        if (key_frames[mid] <= frame_index) { lo = mid;     }
+        else                                { hi = mid - 1; }
+    }
+
+    result = lo;
+
+    if (cursor_key) { *cursor_key = cast(U16) result; }
+
+    return result;
+}
+
+// Locates the pair of quantised values surrounding frame_index in a sparse channel
+//
+typedef struct A_SparseKeyPair A_SparseKeyPair;
+struct A_SparseKeyPair {
+    U16 *value0;
+    U16 *value1;
+
+    F32 t;
+};
+
+FileScope A_SparseKeyPair A_SparseKeyPairGet(A_Animation *animation, A_Channel *channel, U32 frame_index, U16 *cursor_key) {
+    A_SparseKeyPair result;
+
+    U16 *header     = cast(U16 *) (animation->keys + channel->offset);
+    U32  num_keys   = header[0];
+    U16 *key_frames = &header[2];
+    U16 *values     = &key_frames[num_keys];
+
+    U32 key  = A_SparseKeyFind(key_frames, num_keys, frame_index, cursor_key);
+    U32 next = Min(key + 1, num_keys - 1);
+
+    result.value0 = &values[3 * key];
+    result.value1 = &values[3 * next];
+    result.t      = 0;
+
+    if (next != key) {
+        result.t = cast(F32) (frame_index - key_frames[key]) / cast(F32) (key_frames[next] - key_frames[key]);
     }
 
-    // we must do this in a second pass becuase the original sample matrix may be used by
-    // child bones to calculate their final transforms
+    return result;
+}
+
+// Evaluates every curve component of the clip at the frame specified. all curves share the same knots so the
+// hermite basis only has to be calculated once and the components can be evaluated WIDE_LANES at a time
+//
+FileScope void A_AnimationCurvesEvaluate(F32 *output, A_Animation *animation, U32 frame_index) {
+    U16 *knot_frames = animation->knot_frames;
+
+    U32 knot = A_SparseKeyFind(knot_frames, animation->num_knots, frame_index, 0);
+    U32 next = Min(knot + 1, animation->num_knots - 1);
+
+    F32 length = cast(F32) (knot_frames[next] - knot_frames[knot]);
+    F32 t      = (length > 0) ? (cast(F32) (frame_index - knot_frames[knot]) / length) : 0.0f;
+
+    F32 t2 = t  * t;
+    F32 t3 = t2 * t;
+
+    // tangents are stored per frame so have to be scaled by the length of the segment
     //
-    for (U32 it = 0; it < skeleton->num_bones; ++it) {
-        A_Bone *bone = &skeleton->bones[it];
-        output_matrices[it] = M4x4FMul(output_matrices[it], bone->inv_bind_pose);
+    WideF32 h00 = WideF32Set1((2 * t3) - (3 * t2) + 1);
+    WideF32 h10 = WideF32Set1((t3 - (2 * t2) + t) * length);
+    WideF32 h01 = WideF32Set1((3 * t2) - (2 * t3));
+    WideF32 h11 = WideF32Set1((t3 - t2) * length);
+
+    U32 stride = animation->curve_stride;
+
+    F32 *p0 = &animation->curves[2 * stride * knot];
+    F32 *m0 = p0 + stride;
+    F32 *p1 = &animation->curves[2 * stride * next];
+    F32 *m1 = p1 + stride;
+
+    for (U32 it = 0; it < stride; it += WIDE_LANES) {
+        WideF32 result;
+
+        result = WideF32Mul(h00, WideF32Load(&p0[it]));
+        result = WideF32Add(result, WideF32Mul(h10, WideF32Load(&m0[it])));
+        result = WideF32Add(result, WideF32Mul(h01, WideF32Load(&p1[it])));
+        result = WideF32Add(result, WideF32Mul(h11, WideF32Load(&m1[it])));
+
+        WideF32Store(&output[it], result);
     }
 }
 
-#include "math.cpp"
-#include "vulkan.cpp"
+// Everything needed to decode the channels of a single frame
+//
+typedef struct A_Frame A_Frame;
+struct A_Frame {
+    U32 index;
+
+    U8  *data;   // quantised and raw channel data
+    F32 *curves; // evaluated curve components, null if the clip has no curves
+};
+
+FileScope A_Frame A_AnimationFrameGet(Arena *arena, A_Animation *animation, U32 frame_index) {
+    A_Frame result;
+
+    Assert(frame_index < animation->num_frames);
+
+    result.index  = frame_index;
+    result.data   = animation->frames + (cast(U64) animation->frame_stride * frame_index);
+    result.curves = 0;
+
+    if (animation->num_knots != 0) {
+        U32 alignment = WIDE_MAX_LANES * sizeof(F32);
+
+        result.curves = ArenaPush(arena, F32, animation->curve_stride, ARENA_FLAG_NO_ZERO, alignment);
+        A_AnimationCurvesEvaluate(result.curves, animation, frame_index);
+    }
+
+    return result;
+}
+
+FileScope Vec3F A_QuantisedV3FDecode(U16 *value, Vec3F min, Vec3F step) {
+    Vec3F result;
+
+    result.x = min.x + (step.x * value[0]);
+    result.y = min.y + (step.y * value[1]);
+    result.z = min.z + (step.z * value[2]);
+
+    return result;
+}
+
+// Smallest three orientation decode, see the AMTS version 2 format in file_formats.h
+//
+#define A_SMALLEST_THREE_RANGE 0.70710678118f
+
+FileScope Quat4F A_QuantisedQ4FDecode(U16 *value) {
+    Quat4F result;
+
+    U32 largest = (value[0] >> 15) | ((value[1] >> 15) << 1);
+    F32 scale   = (2.0f * A_SMALLEST_THREE_RANGE) / 32767.0f;
+    F32 sum     = 0;
+
+    for (U32 it = 0, c = 0; it < 4; ++it) {
+        if (it != largest) {
+            F32 e = ((value[c] & 0x7FFF) * scale) - A_SMALLEST_THREE_RANGE;
+
+            result.e[it] = e;
+            sum += (e * e);
+
+            c += 1;
+        }
+    }
+
+    result.e[largest] = sqrtf(Max(0.0f, 1.0f - sum));
+
+    return result;
+}
+
+// Positions and scales share the same formats, they only differ in their identity value and quantisation bounds
+//
+FileScope Vec3F A_ChannelV3FDecode(A_Animation *animation, A_Channel *channel, A_Frame *frame, U16 *cursor_key, Vec3F identity, Vec3F min, Vec3F step) {
+    Vec3F result;
+
+    switch (channel->format) {
+        case A_CHANNEL_FORMAT_IDENTITY: { result = identity; } break;
+        case A_CHANNEL_FORMAT_CONSTANT: {
+            F32 *value = &animation->constants[channel->offset];
+            result = V3F(value[0], value[1], value[2]);
+        }
+        break;
+        case A_CHANNEL_FORMAT_QUANTISED: {
+            U16 *value = cast(U16 *) (frame->data + channel->offset);
+            result = A_QuantisedV3FDecode(value, min, step);
+        }
+        break;
+        case A_CHANNEL_FORMAT_SPARSE: {
+            A_SparseKeyPair pair = A_SparseKeyPairGet(animation, channel, frame->index, cursor_key);
+
+            Vec3F a = A_QuantisedV3FDecode(pair.value0, min, step);
+            Vec3F b = A_QuantisedV3FDecode(pair.value1, min, step);
+
+            result = V3FLerp(a, b, pair.t);
+        }
+        break;
+        case A_CHANNEL_FORMAT_CURVE: {
+            F32 *value = &frame->curves[channel->offset];
+            result = V3F(value[0], value[1], value[2]);
+        }
+        break;
+        case A_CHANNEL_FORMAT_RAW: {
+            F32 *value = cast(F32 *) (frame->data + channel->offset);
+            result = V3F(value[0], value[1], value[2]);
+        }
+        break;
+        default: { Assert(!"invalid channel format"); result = identity; } break;
+    }
+
+    return result;
+}
+
+FileScope Quat4F A_ChannelQ4FDecode(A_Animation *animation, A_Channel *channel, A_Frame *frame, U16 *cursor_key) {
+    Quat4F result;
+
+    switch (channel->format) {
+        case A_CHANNEL_FORMAT_IDENTITY: { result = Q4FIdentity(); } break;
+        case A_CHANNEL_FORMAT_CONSTANT: {
+            F32 *value = &animation->constants[channel->offset];
+
+            result.w = value[0];
+            result.x = value[1];
+            result.y = value[2];
+            result.z = value[3];
+        }
+        break;
+        case A_CHANNEL_FORMAT_QUANTISED: {
+            U16 *value = cast(U16 *) (frame->data + channel->offset);
+            result = A_QuantisedQ4FDecode(value);
+        }
+        break;
+        case A_CHANNEL_FORMAT_SPARSE: {
+            A_SparseKeyPair pair = A_SparseKeyPairGet(animation, channel, frame->index, cursor_key);
+
+            Quat4F a = A_QuantisedQ4FDecode(pair.value0);
+            Quat4F b = A_QuantisedQ4FDecode(pair.value1);
+
+            // smallest three always reconstructs the largest component as positive so neighbouring keys can be
+            // on opposite sides of the double cover
+            //
+            if (Q4FDot(a, b) < 0) { b = Q4FNeg(b); }
+
+            result = Q4FNormalizedLerp(a, b, pair.t);
+        }
+        break;
+        case A_CHANNEL_FORMAT_CURVE: {
+            F32 *value = &frame->curves[channel->offset];
+
+            result.w = value[0];
+            result.x = value[1];
+            result.y = value[2];
+            result.z = value[3];
+
+            // the components are fitted independently so the result will be slightly off unit length
+            //
+            result = Q4FNormalize(result);
+        }
+        break;
+        case A_CHANNEL_FORMAT_RAW: {
+            F32 *value = cast(F32 *) (frame->data + channel->offset);
+
+            result.w = value[0];
+            result.x = value[1];
+            result.y = value[2];
+            result.z = value[3];
+        }
+        break;
+        default: { Assert(!"invalid channel format"); result = Q4FIdentity(); } break;
+    }
+
+    return result;
+}
+
+// Returns the cursor keys for the animation, resetting them if the cursor was last used with a different clip
+//
+FileScope U16 *A_CursorKeysGet(A_Cursor *cursor, A_Animation *animation) {
+    U16 *result = 0;
+
+    if (cursor) {
+        if (cursor->animation != animation) {
+            for (U32 it = 0; it < cursor->num_channels; ++it) {
+                cursor->keys[it] = 0;
+            }
+
+            cursor->animation = animation;
+        }
+
+        result = cursor->keys;
+    }
+
+    return result;
+}
+
+// keys is either null or the cursor keys for this bone, one for each channel type
+//
+FileScope A_Sample A_AnimationBoneDecode(A_Animation *animation, U32 bone_index, A_Frame *frame, U16 *keys) {
+    A_Sample result;
+
+    A_Channel *channels = &animation->channels[bone_index * A_CHANNEL_TYPE_COUNT];
+
+    U16 *position_key    = keys ? &keys[A_CHANNEL_TYPE_POSITION]    : 0;
+    U16 *orientation_key = keys ? &keys[A_CHANNEL_TYPE_ORIENTATION] : 0;
+    U16 *scale_key       = keys ? &keys[A_CHANNEL_TYPE_SCALE]       : 0;
+
+    result.position    = A_ChannelV3FDecode(animation, &channels[A_CHANNEL_TYPE_POSITION], frame, position_key, V3F(0, 0, 0), animation->position_min, animation->position_step);
+    result.orientation = A_ChannelQ4FDecode(animation, &channels[A_CHANNEL_TYPE_ORIENTATION], frame, orientation_key);
+    result.scale       = A_ChannelV3FDecode(animation, &channels[A_CHANNEL_TYPE_SCALE], frame, scale_key, V3F(1, 1, 1), animation->scale_min, animation->scale_step);
+
+    return result;
+}
+
+// Decodes both samples required to interpolate a bone between two frames. only the first frame updates the
+// cursor, the second frame starts its search from the keys found for the first but doesn't store them,
+// otherwise the cursor would be ahead of the next call whenever a key lands on index1
+//
+FileScope void A_AnimationBoneDecodePair(A_Sample *sample0, A_Sample *sample1, A_Animation *animation, U32 bone_index, A_Frame *frame0, A_Frame *frame1, U16 *cursor_keys) {
+    U16 *keys0 = cursor_keys ? &cursor_keys[bone_index * A_CHANNEL_TYPE_COUNT] : 0;
+    U16 *keys1 = 0;
+
+    *sample0 = A_AnimationBoneDecode(animation, bone_index, frame0, keys0);
+
+    U16 keys[A_CHANNEL_TYPE_COUNT];
+    if (keys0) {
+        keys[A_CHANNEL_TYPE_POSITION]    = keys0[A_CHANNEL_TYPE_POSITION];
+        keys[A_CHANNEL_TYPE_ORIENTATION] = keys0[A_CHANNEL_TYPE_ORIENTATION];
+        keys[A_CHANNEL_TYPE_SCALE]       = keys0[A_CHANNEL_TYPE_SCALE];
+
+        keys1 = keys;
+    }
+
+    *sample1 = A_AnimationBoneDecode(animation, bone_index, frame1, keys1);
+}
+
+void A_AnimationFrameDecode(A_Sample *output_samples, A_Animation *animation, U32 num_bones, U32 frame_index, A_Cursor *cursor) {
+    TempArena temp = TempGet(0, 0);
+
+    A_Frame frame = A_AnimationFrameGet(temp.arena, animation, frame_index);
+    U16    *keys  = A_CursorKeysGet(cursor, animation);
+
+    for (U32 it = 0; it < num_bones; ++it) {
+        U16 *bone_keys = keys ? &keys[it * A_CHANNEL_TYPE_COUNT] : 0;
+        output_samples[it] = A_AnimationBoneDecode(animation, it, &frame, bone_keys);
+    }
+
+    TempRelease(&temp);
+}
+
+A_BoneMask A_BoneMaskPush(Arena *arena, U32 num_bones) {
+    A_BoneMask result;
+
+    result.num_bones = num_bones;
+    result.num_words = cast(U32) (AlignUp(num_bones, 64) / 64);
+    result.bits      = ArenaPush(arena, U64, result.num_words);
+
+    return result;
+}
+
+void A_BoneMaskSet(A_BoneMask *mask, U32 bone_index) {
+    Assert(bone_index < mask->num_bones);
+    mask->bits[bone_index / 64] |= (cast(U64) 1 << (bone_index % 64));
+}
+
+void A_BoneMaskClear(A_BoneMask *mask, U32 bone_index) {
+    Assert(bone_index < mask->num_bones);
+    mask->bits[bone_index / 64] &= ~(cast(U64) 1 << (bone_index % 64));
+}
+
+B32 A_BoneMaskTest(A_BoneMask *mask, U32 bone_index) {
+    Assert(bone_index < mask->num_bones);
+
+    B32 result = (mask->bits[bone_index / 64] >> (bone_index % 64)) & 1;
+    return result;
+}
+
+void A_BoneMaskSubtreeSet(A_BoneMask *mask, A_Skeleton *skeleton, U32 bone_index) {
+    Assert(mask->num_bones == skeleton->num_bones);
+
+    A_BoneMaskSet(mask, bone_index);
+
+    // parents always come before their children so a single pass is enough to reach every descendant
+    //
+    for (U32 it = bone_index + 1; it < skeleton->num_bones; ++it) {
+        U32 parent = skeleton->bones[it].parent_index;
+
+        if (parent != 0xFF && A_BoneMaskTest(mask, parent)) {
+            A_BoneMaskSet(mask, it);
+        }
+    }
+}
+
+// Each coarser level only keeps subtrees with at least four times the share of the total skin weight of the level
+// before, starting from this share at level 1, and removes one more level of depth from the bottom of the hierarchy
+//
+#define A_BONE_LOD_MIN_INFLUENCE 0.005f
+
+void A_SkeletonLodsBuild(Arena *arena, A_Skeleton *skeleton, A_Mesh *mesh, U32 num_lods) {
+    U32 num_bones = skeleton->num_bones;
+
+    TempArena temp = TempGet(1, &arena);
+
+    F32 *influence = ArenaPush(temp.arena, F32, num_bones);
+    U32 *depth     = ArenaPush(temp.arena, U32, num_bones);
+
+    F32 total_influence = 0;
+
+    for (U32 it = 0; mesh && it < mesh->num_submeshes; ++it) {
+        A_Submesh *submesh = &mesh->submeshes[it];
+        if (!(submesh->flags & AMTM_MESH_FLAG_IS_SKINNED)) { continue; }
+
+        R_SkinnedVertex3 *vertices = cast(R_SkinnedVertex3 *) submesh->vertices;
+
+        for (U32 v = 0; v < submesh->num_vertices; ++v) {
+            for (U32 w = 0; w < 4; ++w) {
+                U32 bone   = vertices[v].bone_indices[w];
+                F32 weight = vertices[v].bone_weights[w] / 255.0f;
+
+                if (bone < num_bones) {
+                    influence[bone] += weight;
+                    total_influence += weight;
+                }
+            }
+        }
+    }
+
+    if (total_influence == 0) {
+        // no skin weights, every bone is treated the same so only the depth is considered
+        //
+        for (U32 it = 0; it < num_bones; ++it) { influence[it] = 1.0f; }
+        total_influence = cast(F32) num_bones;
+    }
+
+    // children always come after their parents so walking backwards accumulates the whole subtree
+    //
+    for (U32 it = num_bones; it-- > 0;) {
+        U32 parent = skeleton->bones[it].parent_index;
+        if (parent != 0xFF) { influence[parent] += influence[it]; }
+    }
+
+    U32 max_depth = 0;
+
+    for (U32 it = 0; it < num_bones; ++it) {
+        U32 parent = skeleton->bones[it].parent_index;
+
+        depth[it] = (parent == 0xFF) ? 0 : (depth[parent] + 1);
+        max_depth = Max(max_depth, depth[it]);
+    }
+
+    num_lods = Max(num_lods, 1);
+
+    skeleton->num_lods = num_lods;
+    skeleton->lods     = ArenaPush(arena, A_BoneLod, num_lods);
+
+    for (U32 l = 0; l < num_lods; ++l) {
+        A_BoneLod *lod = &skeleton->lods[l];
+
+        F32 min_share = (l == 0) ? 0 : (A_BONE_LOD_MIN_INFLUENCE * (1 << (2 * (l - 1))));
+        U32 max_level = (max_depth > l) ? (max_depth - l) : 0;
+
+        lod->num_kept   = 0;
+        lod->kept       = A_BoneMaskPush(arena, num_bones);
+        lod->skin_bones = ArenaPush(arena, U32, num_bones, ARENA_FLAG_NO_ZERO);
+
+        for (U32 it = 0; it < num_bones; ++it) {
+            U32 parent = skeleton->bones[it].parent_index;
+
+            B32 keep = (parent == 0xFF);
+            if (!keep && A_BoneMaskTest(&lod->kept, parent)) {
+                keep = (depth[it] <= max_level) && (influence[it] >= (min_share * total_influence));
+            }
+
+            if (keep) {
+                A_BoneMaskSet(&lod->kept, it);
+
+                lod->skin_bones[it] = it;
+                lod->num_kept      += 1;
+            }
+            else {
+                lod->skin_bones[it] = lod->skin_bones[parent];
+            }
+        }
+    }
+
+    TempRelease(&temp);
+}
+
+A_BoneLod *A_SkeletonLodGet(A_Skeleton *skeleton, U32 lod) {
+    A_BoneLod *result = 0;
+
+    if (lod != 0 && skeleton->num_lods > 1) {
+        result = &skeleton->lods[Min(lod, skeleton->num_lods - 1)];
+    }
+
+    return result;
+}
+
+// The bones to sample for the mask at the lod level, this is the mask itself if the lod keeps every bone
+//
+FileScope A_BoneMask *A_BoneMaskLodApply(Arena *arena, A_BoneMask *mask, A_BoneLod *lod) {
+    A_BoneMask *result = mask;
+
+    if (lod) {
+        if (mask) {
+            result  = ArenaPush(arena, A_BoneMask);
+            *result = *mask;
+
+            result->bits = ArenaPush(arena, U64, mask->num_words, ARENA_FLAG_NO_ZERO);
+
+            for (U32 it = 0; it < mask->num_words; ++it) {
+                result->bits[it] = mask->bits[it] & lod->kept.bits[it];
+            }
+        }
+        else {
+            result = &lod->kept;
+        }
+    }
+
+    return result;
+}
+
+// Bit n is set if bone (base + n) is in the mask. base must be a multiple of WIDE_LANES so the block never crosses
+// a word
+//
+#define A_BONE_MASK_BLOCK_FULL ((1 << WIDE_LANES) - 1)
+
+FileScope U32 A_BoneMaskBlockGet(A_BoneMask *mask, U32 base) {
+    U32 result = A_BONE_MASK_BLOCK_FULL;
+
+    if (mask) {
+        result = cast(U32) (mask->bits[base / 64] >> (base % 64)) & A_BONE_MASK_BLOCK_FULL;
+    }
+
+    return result;
+}
+
+A_Pose A_PosePush(Arena *arena, U32 num_bones) {
+    A_Pose result;
+
+    result.num_bones = num_bones;
+    result.capacity  = cast(U32) AlignUp(num_bones, WIDE_MAX_LANES);
+
+    U32 capacity  = result.capacity;
+    U32 alignment = WIDE_MAX_LANES * sizeof(F32);
+
+    F32 *streams = ArenaPush(arena, F32, 10 * capacity, ARENA_FLAG_NO_ZERO, alignment);
+
+    result.px = streams + (0 * capacity);
+    result.py = streams + (1 * capacity);
+    result.pz = streams + (2 * capacity);
+
+    result.qw = streams + (3 * capacity);
+    result.qx = streams + (4 * capacity);
+    result.qy = streams + (5 * capacity);
+    result.qz = streams + (6 * capacity);
+
+    result.sx = streams + (7 * capacity);
+    result.sy = streams + (8 * capacity);
+    result.sz = streams + (9 * capacity);
+
+    A_Sample identity;
+    identity.position    = V3F(0, 0, 0);
+    identity.orientation = Q4FIdentity();
+    identity.scale       = V3F(1, 1, 1);
+
+    for (U32 it = 0; it < capacity; ++it) {
+        A_PoseSampleSet(&result, it, &identity);
+    }
+
+    return result;
+}
+
+A_Sample A_PoseSampleGet(A_Pose *pose, U32 bone_index) {
+    A_Sample result;
+
+    result.position.x = pose->px[bone_index];
+    result.position.y = pose->py[bone_index];
+    result.position.z = pose->pz[bone_index];
+
+    result.orientation.w = pose->qw[bone_index];
+    result.orientation.x = pose->qx[bone_index];
+    result.orientation.y = pose->qy[bone_index];
+    result.orientation.z = pose->qz[bone_index];
+
+    result.scale.x = pose->sx[bone_index];
+    result.scale.y = pose->sy[bone_index];
+    result.scale.z = pose->sz[bone_index];
+
+    return result;
+}
+
+void A_PoseSampleSet(A_Pose *pose, U32 bone_index, A_Sample *sample) {
+    pose->px[bone_index] = sample->position.x;
+    pose->py[bone_index] = sample->position.y;
+    pose->pz[bone_index] = sample->position.z;
+
+    pose->qw[bone_index] = sample->orientation.w;
+    pose->qx[bone_index] = sample->orientation.x;
+    pose->qy[bone_index] = sample->orientation.y;
+    pose->qz[bone_index] = sample->orientation.z;
+
+    pose->sx[bone_index] = sample->scale.x;
+    pose->sy[bone_index] = sample->scale.y;
+    pose->sz[bone_index] = sample->scale.z;
+}
+
+void A_PoseFromSamples(A_Pose *pose, A_Sample *samples) {
+    for (U32 it = 0; it < pose->num_bones; ++it) {
+        A_PoseSampleSet(pose, it, &samples[it]);
+    }
+}
+
+void A_PoseToSamples(A_Sample *samples, A_Pose *pose) {
+    for (U32 it = 0; it < pose->num_bones; ++it) {
+        samples[it] = A_PoseSampleGet(pose, it);
+    }
+}
+
+// WIDE_LANES bones worth of samples, one component per register
+//
+typedef struct A_WideSample A_WideSample;
+struct A_WideSample {
+    WideF32 px, py, pz;
+    WideF32 qw, qx, qy, qz;
+    WideF32 sx, sy, sz;
+};
+
+FileScope A_WideSample A_WideSampleLoad(A_Pose *pose, U32 base) {
+    A_WideSample result;
+
+    result.px = WideF32Load(&pose->px[base]);
+    result.py = WideF32Load(&pose->py[base]);
+    result.pz = WideF32Load(&pose->pz[base]);
+
+    result.qw = WideF32Load(&pose->qw[base]);
+    result.qx = WideF32Load(&pose->qx[base]);
+    result.qy = WideF32Load(&pose->qy[base]);
+    result.qz = WideF32Load(&pose->qz[base]);
+
+    result.sx = WideF32Load(&pose->sx[base]);
+    result.sy = WideF32Load(&pose->sy[base]);
+    result.sz = WideF32Load(&pose->sz[base]);
+
+    return result;
+}
+
+FileScope void A_WideSampleStore(A_Pose *pose, U32 base, A_WideSample *sample) {
+    WideF32Store(&pose->px[base], sample->px);
+    WideF32Store(&pose->py[base], sample->py);
+    WideF32Store(&pose->pz[base], sample->pz);
+
+    WideF32Store(&pose->qw[base], sample->qw);
+    WideF32Store(&pose->qx[base], sample->qx);
+    WideF32Store(&pose->qy[base], sample->qy);
+    WideF32Store(&pose->qz[base], sample->qz);
+
+    WideF32Store(&pose->sx[base], sample->sx);
+    WideF32Store(&pose->sy[base], sample->sy);
+    WideF32Store(&pose->sz[base], sample->sz);
+}
+
+// Only stores the lanes set in bits, see A_BoneMaskBlockGet
+//
+FileScope void A_WideSampleStoreMasked(A_Pose *pose, U32 base, A_WideSample *sample, U32 bits) {
+    if (bits == A_BONE_MASK_BLOCK_FULL) {
+        A_WideSampleStore(pose, base, sample);
+    }
+    else {
+        WideF32 lanes = WideF32MaskFromBits(bits);
+
+        A_WideSample existing = A_WideSampleLoad(pose, base);
+        A_WideSample result;
+
+        result.px = WideF32Select(lanes, sample->px, existing.px);
+        result.py = WideF32Select(lanes, sample->py, existing.py);
+        result.pz = WideF32Select(lanes, sample->pz, existing.pz);
+
+        result.qw = WideF32Select(lanes, sample->qw, existing.qw);
+        result.qx = WideF32Select(lanes, sample->qx, existing.qx);
+        result.qy = WideF32Select(lanes, sample->qy, existing.qy);
+        result.qz = WideF32Select(lanes, sample->qz, existing.qz);
+
+        result.sx = WideF32Select(lanes, sample->sx, existing.sx);
+        result.sy = WideF32Select(lanes, sample->sy, existing.sy);
+        result.sz = WideF32Select(lanes, sample->sz, existing.sz);
+
+        A_WideSampleStore(pose, base, &result);
+    }
+}
+
+// Wide version of A_SampleLerp, operations are performed in the same order as the scalar version so results
+// only differ by whatever the compiler decides to contract into fused multiply-adds
+//
+FileScope A_WideSample A_WideSampleLerp(A_WideSample *a, A_WideSample *b, WideF32 t) {
+    A_WideSample result;
+
+    result.px = WideF32Lerp(a->px, b->px, t);
+    result.py = WideF32Lerp(a->py, b->py, t);
+    result.pz = WideF32Lerp(a->pz, b->pz, t);
+
+    result.sx = WideF32Lerp(a->sx, b->sx, t);
+    result.sy = WideF32Lerp(a->sy, b->sy, t);
+    result.sz = WideF32Lerp(a->sz, b->sz, t);
+
+    // double cover, rather than branching per-lane the sign bit of b is flipped in the lanes where the dot
+    // product is negative
+    //
+    WideF32 dot;
+    dot = WideF32Mul(a->qw, b->qw);
+    dot = WideF32Add(dot, WideF32Mul(a->qx, b->qx));
+    dot = WideF32Add(dot, WideF32Mul(a->qy, b->qy));
+    dot = WideF32Add(dot, WideF32Mul(a->qz, b->qz));
+
+    WideF32 negative = WideF32LessThan(dot, WideF32Set1(0.0f));
+    WideF32 sign     = WideF32And(negative, WideF32Set1(-0.0f));
+
+    WideF32 qw = WideF32Lerp(a->qw, WideF32Xor(b->qw, sign), t);
+    WideF32 qx = WideF32Lerp(a->qx, WideF32Xor(b->qx, sign), t);
+    WideF32 qy = WideF32Lerp(a->qy, WideF32Xor(b->qy, sign), t);
+    WideF32 qz = WideF32Lerp(a->qz, WideF32Xor(b->qz, sign), t);
+
+    // :note unlike Q4FNormalize this doesn't check for zero length, after the double cover flip the inputs
+    // are within 90 degrees of each other so unit length quaternions can't lerp through zero
+    //
+    WideF32 length;
+    length = WideF32Mul(qw, qw);
+    length = WideF32Add(length, WideF32Mul(qx, qx));
+    length = WideF32Add(length, WideF32Mul(qy, qy));
+    length = WideF32Add(length, WideF32Mul(qz, qz));
+    length = WideF32Sqrt(length);
+
+    WideF32 inv = WideF32Div(WideF32Set1(1.0f), length);
+
+    result.qw = WideF32Mul(qw, inv);
+    result.qx = WideF32Mul(qx, inv);
+    result.qy = WideF32Mul(qy, inv);
+    result.qz = WideF32Mul(qz, inv);
+
+    return result;
+}
+
+void A_PoseLerp(A_Pose *output, A_Pose *a, A_Pose *b, F32 t, A_BoneMask *mask) {
+    Assert(a->num_bones == output->num_bones && b->num_bones == output->num_bones);
+
+    WideF32 wide_t = WideF32Set1(t);
+
+    for (U32 base = 0; base < output->num_bones; base += WIDE_LANES) {
+        U32 bits = A_BoneMaskBlockGet(mask, base);
+        if (!bits) { continue; }
+
+        A_WideSample wa = A_WideSampleLoad(a, base);
+        A_WideSample wb = A_WideSampleLoad(b, base);
+
+        A_WideSample result = A_WideSampleLerp(&wa, &wb, wide_t);
+        A_WideSampleStoreMasked(output, base, &result, bits);
+    }
+}
+
+void A_PoseLerpMasked(A_Pose *output, A_Pose *a, A_Pose *b, F32 *bone_weights, F32 t, A_BoneMask *mask) {
+    Assert(a->num_bones == output->num_bones && b->num_bones == output->num_bones);
+
+    WideF32 wide_t = WideF32Set1(t);
+
+    for (U32 base = 0; base < output->num_bones; base += WIDE_LANES) {
+        U32 bits = A_BoneMaskBlockGet(mask, base);
+        if (!bits) { continue; }
+
+        A_WideSample wa = A_WideSampleLoad(a, base);
+        A_WideSample wb = A_WideSampleLoad(b, base);
+
+        WideF32 bone_t = WideF32Mul(WideF32Load(&bone_weights[base]), wide_t);
+
+        A_WideSample result = A_WideSampleLerp(&wa, &wb, bone_t);
+        A_WideSampleStoreMasked(output, base, &result, bits);
+    }
+}
+
+// Hamilton product (a * b) for WIDE_LANES quaternions at a time
+//
+FileScope void A_WideQuatMul(WideF32 *qw, WideF32 *qx, WideF32 *qy, WideF32 *qz, WideF32 aw, WideF32 ax, WideF32 ay, WideF32 az, WideF32 bw, WideF32 bx, WideF32 by, WideF32 bz) {
+    WideF32 w = WideF32Sub(WideF32Sub(WideF32Sub(WideF32Mul(aw, bw), WideF32Mul(ax, bx)), WideF32Mul(ay, by)), WideF32Mul(az, bz));
+    WideF32 x = WideF32Sub(WideF32Add(WideF32Add(WideF32Mul(aw, bx), WideF32Mul(ax, bw)), WideF32Mul(ay, bz)), WideF32Mul(az, by));
+    WideF32 y = WideF32Add(WideF32Add(WideF32Sub(WideF32Mul(aw, by), WideF32Mul(ax, bz)), WideF32Mul(ay, bw)), WideF32Mul(az, bx));
+    WideF32 z = WideF32Add(WideF32Sub(WideF32Add(WideF32Mul(aw, bz), WideF32Mul(ax, by)), WideF32Mul(ay, bx)), WideF32Mul(az, bw));
+
+    *qw = w;
+    *qx = x;
+    *qy = y;
+    *qz = z;
+}
+
+FileScope void A_WideQuatNormalize(WideF32 *qw, WideF32 *qx, WideF32 *qy, WideF32 *qz) {
+    WideF32 length;
+    length = WideF32Mul(*qw, *qw);
+    length = WideF32Add(length, WideF32Mul(*qx, *qx));
+    length = WideF32Add(length, WideF32Mul(*qy, *qy));
+    length = WideF32Add(length, WideF32Mul(*qz, *qz));
+    length = WideF32Sqrt(length);
+
+    WideF32 inv = WideF32Div(WideF32Set1(1.0f), length);
+
+    *qw = WideF32Mul(*qw, inv);
+    *qx = WideF32Mul(*qx, inv);
+    *qy = WideF32Mul(*qy, inv);
+    *qz = WideF32Mul(*qz, inv);
+}
+
+// Applies the difference d to b scaled by t, the scale factor is lerped from one and the orientation is nlerped from
+// identity
+//
+FileScope A_WideSample A_WideSampleAdditiveApply(A_WideSample *b, A_WideSample *d, WideF32 t) {
+    A_WideSample result;
+
+    WideF32 zero = WideF32Set1(0.0f);
+    WideF32 one  = WideF32Set1(1.0f);
+
+    result.px = WideF32Add(b->px, WideF32Mul(d->px, t));
+    result.py = WideF32Add(b->py, WideF32Mul(d->py, t));
+    result.pz = WideF32Add(b->pz, WideF32Mul(d->pz, t));
+
+    result.sx = WideF32Mul(b->sx, WideF32Lerp(one, d->sx, t));
+    result.sy = WideF32Mul(b->sy, WideF32Lerp(one, d->sy, t));
+    result.sz = WideF32Mul(b->sz, WideF32Lerp(one, d->sz, t));
+
+    // the difference is put on the same side as identity first so it takes the shortest path
+    //
+    WideF32 negative = WideF32LessThan(d->qw, zero);
+    WideF32 sign     = WideF32And(negative, WideF32Set1(-0.0f));
+
+    WideF32 dw = WideF32Lerp(one,  WideF32Xor(d->qw, sign), t);
+    WideF32 dx = WideF32Lerp(zero, WideF32Xor(d->qx, sign), t);
+    WideF32 dy = WideF32Lerp(zero, WideF32Xor(d->qy, sign), t);
+    WideF32 dz = WideF32Lerp(zero, WideF32Xor(d->qz, sign), t);
+
+    A_WideQuatNormalize(&dw, &dx, &dy, &dz);
+    A_WideQuatMul(&result.qw, &result.qx, &result.qy, &result.qz, b->qw, b->qx, b->qy, b->qz, dw, dx, dy, dz);
+
+    return result;
+}
+
+void A_PoseAdditive(A_Pose *output, A_Pose *base, A_Pose *additive, A_Pose *reference, F32 t, A_BoneMask *mask) {
+    Assert(base->num_bones == output->num_bones && additive->num_bones == output->num_bones);
+    Assert(!reference || reference->num_bones == output->num_bones);
+
+    WideF32 wide_t = WideF32Set1(t);
+
+    for (U32 it = 0; it < output->num_bones; it += WIDE_LANES) {
+        U32 bits = A_BoneMaskBlockGet(mask, it);
+        if (!bits) { continue; }
+
+        A_WideSample b = A_WideSampleLoad(base, it);
+        A_WideSample d = A_WideSampleLoad(additive, it);
+
+        if (reference) {
+            // difference relative to the reference, orientation is conjugate(r) * a
+            //
+            A_WideSample r = A_WideSampleLoad(reference, it);
+
+            d.px = WideF32Sub(d.px, r.px);
+            d.py = WideF32Sub(d.py, r.py);
+            d.pz = WideF32Sub(d.pz, r.pz);
+
+            WideF32 sign = WideF32Set1(-0.0f);
+            A_WideQuatMul(&d.qw, &d.qx, &d.qy, &d.qz, r.qw, WideF32Xor(r.qx, sign), WideF32Xor(r.qy, sign), WideF32Xor(r.qz, sign), d.qw, d.qx, d.qy, d.qz);
+
+            d.sx = WideF32Div(d.sx, r.sx);
+            d.sy = WideF32Div(d.sy, r.sy);
+            d.sz = WideF32Div(d.sz, r.sz);
+        }
+
+        A_WideSample result = A_WideSampleAdditiveApply(&b, &d, wide_t);
+        A_WideSampleStoreMasked(output, it, &result, bits);
+    }
+}
+
+void A_PoseAdditiveStack(A_Pose *output, A_Pose *base, A_Pose **layers, F32 *weights, U32 count, A_BoneMask *mask) {
+    Assert(base->num_bones == output->num_bones);
+
+    for (U32 it = 0; it < output->num_bones; it += WIDE_LANES) {
+        U32 bits = A_BoneMaskBlockGet(mask, it);
+        if (!bits) { continue; }
+
+        A_WideSample result = A_WideSampleLoad(base, it);
+
+        for (U32 l = 0; l < count; ++l) {
+            if (weights[l] == 0) { continue; }
+
+            Assert(layers[l]->num_bones == output->num_bones);
+
+            A_WideSample d = A_WideSampleLoad(layers[l], it);
+            result = A_WideSampleAdditiveApply(&result, &d, WideF32Set1(weights[l]));
+        }
+
+        A_WideSampleStoreMasked(output, it, &result, bits);
+    }
+}
+
+void A_PoseBlend(A_Pose *output, A_Pose **inputs, F32 *weights, U32 count, A_BoneMask *mask) {
+    U32 first = 0;
+    while (first < count && weights[first] == 0) { first += 1; }
+
+    Assert(first < count);
+
+    for (U32 base = 0; base < output->num_bones; base += WIDE_LANES) {
+        U32 bits = A_BoneMaskBlockGet(mask, base);
+        if (!bits) { continue; }
+
+        A_WideSample reference = A_WideSampleLoad(inputs[first], base);
+        A_WideSample result;
+
+        WideF32 w = WideF32Set1(weights[first]);
+
+        result.px = WideF32Mul(reference.px, w);
+        result.py = WideF32Mul(reference.py, w);
+        result.pz = WideF32Mul(reference.pz, w);
+
+        result.qw = WideF32Mul(reference.qw, w);
+        result.qx = WideF32Mul(reference.qx, w);
+        result.qy = WideF32Mul(reference.qy, w);
+        result.qz = WideF32Mul(reference.qz, w);
+
+        result.sx = WideF32Mul(reference.sx, w);
+        result.sy = WideF32Mul(reference.sy, w);
+        result.sz = WideF32Mul(reference.sz, w);
+
+        for (U32 it = first + 1; it < count; ++it) {
+            if (weights[it] == 0) { continue; }
+
+            A_Pose *input = inputs[it];
+            Assert(input->num_bones == output->num_bones);
+
+            A_WideSample sample = A_WideSampleLoad(input, base);
+
+            w = WideF32Set1(weights[it]);
+
+            result.px = WideF32Add(result.px, WideF32Mul(sample.px, w));
+            result.py = WideF32Add(result.py, WideF32Mul(sample.py, w));
+            result.pz = WideF32Add(result.pz, WideF32Mul(sample.pz, w));
+
+            result.sx = WideF32Add(result.sx, WideF32Mul(sample.sx, w));
+            result.sy = WideF32Add(result.sy, WideF32Mul(sample.sy, w));
+            result.sz = WideF32Add(result.sz, WideF32Mul(sample.sz, w));
+
+            // double cover, each orientation is flipped onto the same side as the first weighted input
+            //
+            WideF32 dot;
+            dot = WideF32Mul(reference.qw, sample.qw);
+            dot = WideF32Add(dot, WideF32Mul(reference.qx, sample.qx));
+            dot = WideF32Add(dot, WideF32Mul(reference.qy, sample.qy));
+            dot = WideF32Add(dot, WideF32Mul(reference.qz, sample.qz));
+
+            WideF32 negative = WideF32LessThan(dot, WideF32Set1(0.0f));
+            WideF32 signed_w = WideF32Xor(w, WideF32And(negative, WideF32Set1(-0.0f)));
+
+            result.qw = WideF32Add(result.qw, WideF32Mul(sample.qw, signed_w));
+            result.qx = WideF32Add(result.qx, WideF32Mul(sample.qx, signed_w));
+            result.qy = WideF32Add(result.qy, WideF32Mul(sample.qy, signed_w));
+            result.qz = WideF32Add(result.qz, WideF32Mul(sample.qz, signed_w));
+        }
+
+        A_WideQuatNormalize(&result.qw, &result.qx, &result.qy, &result.qz);
+        A_WideSampleStoreMasked(output, base, &result, bits);
+    }
+}
+
+A_Playback A_PlaybackCreate(U32 animation_index, A_LoopMode loop_mode) {
+    A_Playback result;
+    result.animation_index = animation_index;
+    result.time            = 0;
+    result.time_scale      = 1;
+    result.loop_mode       = loop_mode;
+    result.cursor          = 0;
+
+    return result;
+}
+
+// Brings the time provided back into the valid range for the animation based on the loop mode
+//
+FileScope F32 A_AnimationTimeLoop(A_Animation *animation, U32 framerate, F32 time, A_LoopMode loop_mode) {
+    F32 result = time;
+
+    F32 inv_framerate = 1.0f / cast(F32) framerate;
+
+    if (loop_mode == A_LOOP_MODE_CLAMP) {
+        F32 end_time = inv_framerate * (animation->num_frames - 1);
+        result = Clamp(0, result, end_time);
+    }
+    else {
+        F32 total_time = inv_framerate * animation->num_frames;
+
+        if (result >= total_time || result < 0) {
+            // :note truncates towards zero so negative times will still be negative after this, we
+            // only need at most one correction afterwards
+            //
+            result -= cast(S32) (result / total_time) * total_time;
+            if (result < 0) { result += total_time; }
+
+            // floating point error can put us exactly on the end
+            //
+            if (result >= total_time) { result = 0; }
+        }
+    }
+
+    return result;
+}
+
+void A_PlaybackAdvance(A_Playback *playback, A_Skeleton *skeleton, F32 dt) {
+    Assert(playback->animation_index < skeleton->num_animations);
+
+    A_Animation *animation = &skeleton->animations[playback->animation_index];
+
+    playback->time += (playback->time_scale * dt);
+    playback->time  = A_AnimationTimeLoop(animation, skeleton->framerate, playback->time, playback->loop_mode);
+}
+
+FileScope A_FramePair A_AnimationFramePairGet(A_Animation *animation, U32 framerate, F32 time, A_LoopMode loop_mode) {
+    A_FramePair result;
+
+    time = A_AnimationTimeLoop(animation, framerate, time, loop_mode);
+
+    U32 last_frame = animation->num_frames - 1;
+    F32 frame      = time * cast(F32) framerate;
+
+    result.index0 = Min(cast(U32) frame, last_frame);
+
+    if (loop_mode == A_LOOP_MODE_CLAMP) {
+        result.index1 = Min(result.index0 + 1, last_frame);
+    }
+    else {
+        result.index1 = (result.index0 + 1) % animation->num_frames;
+    }
+
+    result.t = Clamp01(frame - cast(F32) result.index0);
+
+    return result;
+}
+
+void A_AnimationSample(A_Sample *output_samples, A_Skeleton *skeleton, U32 animation_index, F32 time, A_LoopMode loop_mode, A_Cursor *cursor, A_BoneMask *mask) {
+    Assert(animation_index < skeleton->num_animations);
+
+    A_Animation *animation = &skeleton->animations[animation_index];
+    A_FramePair  frames    = A_AnimationFramePairGet(animation, skeleton->framerate, time, loop_mode);
+
+    TempArena temp = TempGet(0, 0);
+
+    A_Frame frame0 = A_AnimationFrameGet(temp.arena, animation, frames.index0);
+    A_Frame frame1 = A_AnimationFrameGet(temp.arena, animation, frames.index1);
+
+    U16 *keys = A_CursorKeysGet(cursor, animation);
+
+    // decode both frames per bone directly into the interpolation so no intermediate samples are needed
+    //
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        if (mask && !A_BoneMaskTest(mask, it)) { continue; }
+
+        A_Sample a, b;
+        A_AnimationBoneDecodePair(&a, &b, animation, it, &frame0, &frame1, keys);
+
+        output_samples[it] = A_SampleLerp(&a, &b, frames.t);
+    }
+
+    TempRelease(&temp);
+}
+
+void A_AnimationSamplePose(A_Pose *output, A_Skeleton *skeleton, U32 animation_index, F32 time, A_LoopMode loop_mode, A_Cursor *cursor, A_BoneMask *mask) {
+    Assert(animation_index < skeleton->num_animations);
+    Assert(output->num_bones == skeleton->num_bones);
+
+    A_Animation *animation = &skeleton->animations[animation_index];
+    A_FramePair  frames    = A_AnimationFramePairGet(animation, skeleton->framerate, time, loop_mode);
+
+    TempArena temp = TempGet(0, 0);
+
+    A_Frame frame0 = A_AnimationFrameGet(temp.arena, animation, frames.index0);
+    A_Frame frame1 = A_AnimationFrameGet(temp.arena, animation, frames.index1);
+
+    U16 *keys = A_CursorKeysGet(cursor, animation);
+
+    // the channels are decoded into padded poses so the interpolation can be done entirely with the wide kernels
+    //
+    A_Pose a = A_PosePush(temp.arena, skeleton->num_bones);
+    A_Pose b = A_PosePush(temp.arena, skeleton->num_bones);
+
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        if (mask && !A_BoneMaskTest(mask, it)) { continue; }
+
+        A_Sample sample0, sample1;
+        A_AnimationBoneDecodePair(&sample0, &sample1, animation, it, &frame0, &frame1, keys);
+
+        A_PoseSampleSet(&a, it, &sample0);
+        A_PoseSampleSet(&b, it, &sample1);
+    }
+
+    A_PoseLerp(output, &a, &b, frames.t, mask);
+
+    TempRelease(&temp);
+}
+
+void A_AnimationEvaluate(A_Sample *output_samples, A_Skeleton *skeleton, A_Playback *playback, F32 dt, A_BoneMask *mask, U32 lod) {
+    TempArena temp = TempGet(0, 0);
+
+    A_BoneMask *sample = A_BoneMaskLodApply(temp.arena, mask, A_SkeletonLodGet(skeleton, lod));
+
+    A_PlaybackAdvance(playback, skeleton, dt);
+    A_AnimationSample(output_samples, skeleton, playback->animation_index, playback->time, playback->loop_mode, playback->cursor, sample);
+
+    TempRelease(&temp);
+}
+
+// Returns the bones that need to be solved for the mask, which is every bone with a set bone in its subtree. null
+// if the mask is null
+//
+FileScope A_BoneMask *A_BoneMaskSolveGet(Arena *arena, A_Skeleton *skeleton, A_BoneMask *mask) {
+    A_BoneMask *result = 0;
+
+    if (mask) {
+        Assert(mask->num_bones == skeleton->num_bones);
+
+        result  = ArenaPush(arena, A_BoneMask);
+        *result = *mask;
+
+        result->bits = ArenaPushCopy(arena, mask->bits, U64, mask->num_words);
+
+        // children always come after their parents so walking backwards propagates up the whole chain
+        //
+        for (U32 it = skeleton->num_bones; it-- > 0;) {
+            U32 parent = skeleton->bones[it].parent_index;
+
+            if (parent != 0xFF && A_BoneMaskTest(result, it)) {
+                A_BoneMaskSet(result, parent);
+            }
+        }
+    }
+
+    return result;
+}
+
+// Relative difference allowed between the scale axes of a bone for its children to still be composed as transforms
+//
+#define A_UNIFORM_SCALE_TOLERANCE 0.00001f
+
+// Model space transforms from A_BoneHierarchySolve. a rotated child of a non-uniformly scaled bone is sheared, which
+// a Transform3F can't represent, so the model transform of every bone below one of those is kept as a matrix instead
+//
+// matrices can be null to compose everything as transforms and drop the shear
+//
+typedef struct A_ModelSpace A_ModelSpace;
+struct A_ModelSpace {
+    Transform3F *transforms;
+    Mat3x4F     *matrices;   // only valid for bones set in sheared
+    A_BoneMask   sheared;
+};
+
+FileScope A_ModelSpace A_ModelSpacePush(Arena *arena, U32 num_bones) {
+    A_ModelSpace result;
+
+    result.transforms = ArenaPush(arena, Transform3F, num_bones, ARENA_FLAG_NO_ZERO);
+    result.matrices   = ArenaPush(arena, Mat3x4F,     num_bones, ARENA_FLAG_NO_ZERO);
+    result.sheared    = A_BoneMaskPush(arena, num_bones);
+
+    return result;
+}
+
+FileScope B32 A_ScaleIsUniform(Vec3F scale) {
+    F32 tolerance = A_UNIFORM_SCALE_TOLERANCE * Max(Max(Abs(scale.x), Abs(scale.y)), Abs(scale.z));
+
+    B32 result = Abs(scale.x - scale.y) <= tolerance && Abs(scale.x - scale.z) <= tolerance;
+    return result;
+}
+
+// Walks the hierarchy calculating the model space transform for each bone. bones are stored so parents always come
+// before their children, so the parent model transform is always available by the time it is needed
+//
+// solve is from A_BoneMaskSolveGet so the parent of a solved bone is always solved. bones culled by the lod aren't
+// needed, see A_BonePaletteWrite
+//
+FileScope void A_BoneHierarchySolve(A_ModelSpace *model, A_Skeleton *skeleton, A_Sample *local, A_BoneMask *solve, A_BoneLod *lod) {
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        if (solve && !A_BoneMaskTest(solve, it)) { continue; }
+        if (lod   && !A_BoneMaskTest(&lod->kept, it)) { continue; }
+
+        A_Bone *bone   = &skeleton->bones[it];
+        U32     parent = bone->parent_index;
+
+        if (parent == 0xFF) {
+            // root bone
+            //
+            model->transforms[it] = local[it];
+
+            if (model->matrices) { A_BoneMaskClear(&model->sheared, it); }
+            continue;
+        }
+
+        Assert(parent < it);
+
+        B32 sheared = false;
+        if (model->matrices) {
+            sheared = A_BoneMaskTest(&model->sheared, parent) || !A_ScaleIsUniform(model->transforms[parent].scale);
+        }
+
+        if (sheared) {
+            Mat3x4F parent_matrix;
+            if (A_BoneMaskTest(&model->sheared, parent)) {
+                parent_matrix = model->matrices[parent];
+            }
+            else {
+                parent_matrix = T3FToM3x4F(model->transforms[parent]);
+            }
+
+            model->matrices[it] = M3x4FMul(parent_matrix, A_SampleToM3x4F(&local[it]));
+            A_BoneMaskSet(&model->sheared, it);
+        }
+        else {
+            model->transforms[it] = T3FMul(model->transforms[parent], local[it]);
+
+            // the model space may be kept between solves, see A_IncrementalPalette
+            //
+            if (model->matrices) { A_BoneMaskClear(&model->sheared, it); }
+        }
+    }
+}
+
+// This is the only place bones are converted to matrices. bones culled by the lod use the model transform of their
+// closest kept ancestor with its inverse bind pose, which is exactly the skinning matrix of that ancestor
+//
+// when streaming the output is only written with non-temporal stores, so the matrix for culled bones is calculated
+// again rather than copied from the ancestor already written to the output
+//
+FileScope void A_BonePaletteWrite(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_ModelSpace *model, A_BoneMask *solve, A_BoneLod *lod, B32 stream) {
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        if (solve && !A_BoneMaskTest(solve, it)) { continue; }
+
+        U32 bone = it;
+        if (lod && !A_BoneMaskTest(&lod->kept, it)) {
+            bone = lod->skin_bones[it];
+
+            if (!stream) {
+                output_matrices[it] = output_matrices[bone];
+                continue;
+            }
+        }
+
+        Mat3x4F matrix;
+        if (model->matrices && A_BoneMaskTest(&model->sheared, bone)) {
+            matrix = model->matrices[bone];
+        }
+        else {
+            matrix = T3FToM3x4F(model->transforms[bone]);
+        }
+
+        if (stream) {
+            M3x4FMulStream(&output_matrices[it], matrix, skeleton->bones[bone].inv_bind_pose);
+        }
+        else {
+            output_matrices[it] = M3x4FMul(matrix, skeleton->bones[bone].inv_bind_pose);
+        }
+    }
+
+    if (stream) { StoreFence(); }
+}
+
+void A_AnimationModelTransformsGet(Transform3F *output_transforms, A_Skeleton *skeleton, A_Sample *samples, A_BoneMask *mask, U32 lod) {
+    TempArena temp = TempGet(0, 0);
+
+    A_ModelSpace model = { 0 };
+    model.transforms = output_transforms;
+
+    A_BoneMask *solve = A_BoneMaskSolveGet(temp.arena, skeleton, mask);
+    A_BoneHierarchySolve(&model, skeleton, samples, solve, A_SkeletonLodGet(skeleton, lod));
+
+    TempRelease(&temp);
+}
+
+void A_BoneMatricesFromModel(Mat3x4F *output_matrices, A_Skeleton *skeleton, Transform3F *model_transforms, A_BoneMask *mask, U32 lod) {
+    TempArena temp = TempGet(0, 0);
+
+    A_ModelSpace model = { 0 };
+    model.transforms = model_transforms;
+
+    A_BoneMask *solve = A_BoneMaskSolveGet(temp.arena, skeleton, mask);
+    A_BonePaletteWrite(output_matrices, skeleton, &model, solve, A_SkeletonLodGet(skeleton, lod), false);
+
+    TempRelease(&temp);
+}
+
+void A_AnimationBoneMatricesGet(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Sample *samples, A_BoneMask *mask, U32 lod) {
+    TempArena temp = TempGet(0, 0);
+
+    A_ModelSpace model = A_ModelSpacePush(temp.arena, skeleton->num_bones);
+
+    A_BoneLod  *bone_lod = A_SkeletonLodGet(skeleton, lod);
+    A_BoneMask *solve    = A_BoneMaskSolveGet(temp.arena, skeleton, mask);
+
+    A_BoneHierarchySolve(&model, skeleton, samples, solve, bone_lod);
+    A_BonePaletteWrite(output_matrices, skeleton, &model, solve, bone_lod, false);
+
+    TempRelease(&temp);
+}
+
+FileScope void A_PoseBoneMatricesWrite(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Pose *pose, A_BoneMask *mask, U32 lod, B32 stream) {
+    Assert(pose->num_bones == skeleton->num_bones);
+
+    TempArena temp = TempGet(0, 0);
+
+    A_Sample    *local = ArenaPush(temp.arena, A_Sample, skeleton->num_bones, ARENA_FLAG_NO_ZERO);
+    A_ModelSpace model = A_ModelSpacePush(temp.arena, skeleton->num_bones);
+
+    A_BoneLod  *bone_lod = A_SkeletonLodGet(skeleton, lod);
+    A_BoneMask *solve    = A_BoneMaskSolveGet(temp.arena, skeleton, mask);
+    A_BoneMask *build    = A_BoneMaskLodApply(temp.arena, solve, bone_lod);
+
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        if (build && !A_BoneMaskTest(build, it)) { continue; }
+
+        local[it] = A_PoseSampleGet(pose, it);
+    }
+
+    A_BoneHierarchySolve(&model, skeleton, local, solve, bone_lod);
+    A_BonePaletteWrite(output_matrices, skeleton, &model, solve, bone_lod, stream);
+
+    TempRelease(&temp);
+}
+
+void A_PoseBoneMatricesGet(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Pose *pose, A_BoneMask *mask, U32 lod) {
+    A_PoseBoneMatricesWrite(output_matrices, skeleton, pose, mask, lod, false);
+}
+
+void A_PoseBoneMatricesStream(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Pose *pose, A_BoneMask *mask, U32 lod) {
+    A_PoseBoneMatricesWrite(output_matrices, skeleton, pose, mask, lod, true);
+}
+
+A_IncrementalPalette A_IncrementalPaletteCreate(Arena *arena, A_Skeleton *skeleton) {
+    A_IncrementalPalette result = { 0 };
+
+    U32 num_bones = skeleton->num_bones;
+
+    result.skeleton = skeleton;
+
+    result.local          = ArenaPush(arena, A_Sample,    num_bones, ARENA_FLAG_NO_ZERO);
+    result.model          = ArenaPush(arena, Transform3F, num_bones, ARENA_FLAG_NO_ZERO);
+    result.model_matrices = ArenaPush(arena, Mat3x4F,     num_bones, ARENA_FLAG_NO_ZERO);
+    result.sheared        = A_BoneMaskPush(arena, num_bones);
+    result.dirty          = A_BoneMaskPush(arena, num_bones);
+    result.palette        = ArenaPush(arena, Mat3x4F,     num_bones);
+
+    return result;
+}
+
+// Compares the bits rather than the values so the palette is only reused for bones that would produce exactly the
+// same matrix, MemoryCompare is byte at a time which costs more than the solve it saves
+//
+FileScope B32 A_SampleBitsEqual(A_Sample *a, A_Sample *b) {
+    StaticAssert((sizeof(A_Sample) % sizeof(U32)) == 0);
+
+    U32 *x = cast(U32 *) a;
+    U32 *y = cast(U32 *) b;
+
+    U32 diff = 0;
+    for (U32 it = 0; it < (sizeof(A_Sample) / sizeof(U32)); ++it) {
+        diff |= (x[it] ^ y[it]);
+    }
+
+    B32 result = (diff == 0);
+    return result;
+}
+
+void A_IncrementalPaletteUpdate(A_IncrementalPalette *incremental, A_Sample *samples, U32 lod) {
+    A_Skeleton *skeleton = incremental->skeleton;
+    A_BoneLod  *bone_lod = A_SkeletonLodGet(skeleton, lod);
+    A_BoneMask *dirty    = &incremental->dirty;
+
+    A_ModelSpace model;
+    model.transforms = incremental->model;
+    model.matrices   = incremental->model_matrices;
+    model.sheared    = incremental->sheared;
+
+    B32 full = !incremental->valid || (incremental->lod != lod);
+
+    U32 num_dirty = 0;
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        U32 parent = skeleton->bones[it].parent_index;
+
+        if (bone_lod && !A_BoneMaskTest(&bone_lod->kept, it)) {
+            // culled bones use the matrix of their closest kept ancestor so need writing when it changes
+            //
+            if (A_BoneMaskTest(dirty, bone_lod->skin_bones[it])) { A_BoneMaskSet(dirty, it); }
+        }
+        else {
+            B32 changed = full || !A_SampleBitsEqual(&incremental->local[it], &samples[it]);
+            if (changed) { incremental->local[it] = samples[it]; }
+
+            // bones are stored so parents always come before their children, so the dirty bit of the parent is
+            // already final
+            //
+            if (changed || (parent != 0xFF && A_BoneMaskTest(dirty, parent))) { A_BoneMaskSet(dirty, it); }
+        }
+
+        if (A_BoneMaskTest(dirty, it)) { num_dirty += 1; }
+    }
+
+    if (2 * num_dirty > skeleton->num_bones) { full = true; }
+
+    A_BoneMask *solve = full ? 0 : dirty;
+
+    A_BoneHierarchySolve(&model, skeleton, incremental->local, solve, bone_lod);
+    A_BonePaletteWrite(incremental->palette, skeleton, &model, solve, bone_lod, false);
+
+    MemoryZero(dirty->bits, dirty->num_words * sizeof(U64));
+
+    incremental->valid      = true;
+    incremental->lod        = lod;
+    incremental->num_solved = full ? skeleton->num_bones : num_dirty;
+}
+
+U64 A_InstancesPaletteCount(A_Instance *instances, U32 num_instances) {
+    U64 result = 0;
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        result += instances[it].skeleton->num_bones;
+    }
+
+    return result;
+}
+
+// Instances are grouped by sorting on a key made up of:
+//
+//    [16 bit skeleton slot] [23 bit animation index] [1 bit frame wrapped] [24 bit first frame index]
+//
+// the skeleton slot is the index into a list of unique skeletons seen in the batch, the wrapped bit is needed
+// because instances on the final frame can either wrap to the first frame or hold depending on their loop mode
+//
+typedef struct A_BatchKey A_BatchKey;
+struct A_BatchKey {
+    U64 key;
+    U32 index; // into the instances array
+    U32 pad;
+};
+
+FileScope void A_BatchKeysSort(A_BatchKey *keys, A_BatchKey *scratch, U32 count) {
+    A_BatchKey *src = keys;
+    A_BatchKey *dst = scratch;
+
+    // lsd radix sort, 8 bits at a time. most of the key bits will be the same for all instances in the
+    // batch so passes where every key has the same digit are skipped
+    //
+    for (U32 shift = 0; shift < 64; shift += 8) {
+        U32 counts[256] = { 0 };
+
+        for (U32 it = 0; it < count; ++it) {
+            counts[(src[it].key >> shift) & 0xFF] += 1;
+        }
+
+        if (counts[(src[0].key >> shift) & 0xFF] == count) { continue; }
+
+        U32 offset = 0;
+        for (U32 it = 0; it < 256; ++it) {
+            U32 n = counts[it];
+
+            counts[it] = offset;
+            offset    += n;
+        }
+
+        for (U32 it = 0; it < count; ++it) {
+            U32 digit = cast(U32) (src[it].key >> shift) & 0xFF;
+            dst[counts[digit]++] = src[it];
+        }
+
+        A_BatchKey *swap = src;
+
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != keys) {
+        MemoryCopy(keys, src, count * sizeof(A_BatchKey));
+    }
+}
+
+typedef struct A_BatchWork A_BatchWork;
+struct A_BatchWork {
+    Mat3x4F *output_palette;
+
+    A_Instance  *instances;
+    A_BatchKey  *keys;
+    A_FramePair *frames;
+    U64         *offsets;
+
+    U32 *groups; // start of each group in keys
+    U32  first_group;
+    U32  last_group; // exclusive
+};
+
+FileScope void A_BatchWorkRun(void *data) {
+    A_BatchWork *work = cast(A_BatchWork *) data;
+
+    A_BatchKey  *keys   = work->keys;
+    A_FramePair *frames = work->frames;
+
+    TempArena temp = TempGet(0, 0);
+
+    for (U32 it = work->first_group; it < work->last_group; ++it) {
+        U32 first = work->groups[it];
+        U32 count = work->groups[it + 1] - first;
+
+        A_Instance  *lead      = &work->instances[keys[first].index];
+        A_Skeleton  *skeleton  = lead->skeleton;
+        A_Animation *animation = &skeleton->animations[lead->playback.animation_index];
+        A_FramePair *pair      = &frames[keys[first].index];
+
+        U32 num_bones = skeleton->num_bones;
+
+        TempArena group = TempFrom(temp.arena);
+
+        A_Sample *frame0  = ArenaPush(group.arena, A_Sample, num_bones, ARENA_FLAG_NO_ZERO);
+        A_Sample *frame1  = ArenaPush(group.arena, A_Sample, num_bones, ARENA_FLAG_NO_ZERO);
+        A_Sample *samples = ArenaPush(group.arena, A_Sample, count * num_bones, ARENA_FLAG_NO_ZERO);
+
+        A_BoneLod **lods = ArenaPush(group.arena, A_BoneLod *, count, ARENA_FLAG_NO_ZERO);
+
+        for (U32 g = 0; g < count; ++g) {
+            A_Instance *instance = &work->instances[keys[first + g].index];
+            lods[g] = A_SkeletonLodGet(skeleton, instance->lod);
+        }
+
+        // both frames are only decoded once for the whole group, every instance in the group is on the same
+        // frames so the cursor of the first instance is used
+        //
+        A_Frame f0 = A_AnimationFrameGet(group.arena, animation, pair->index0);
+        A_Frame f1 = A_AnimationFrameGet(group.arena, animation, pair->index1);
+
+        U16 *cursor_keys = A_CursorKeysGet(lead->playback.cursor, animation);
+
+        for (U32 bone = 0; bone < num_bones; ++bone) {
+            A_AnimationBoneDecodePair(&frame0[bone], &frame1[bone], animation, bone, &f0, &f1, cursor_keys);
+        }
+
+        // bone-major so each source sample pair is only loaded once for the whole group
+        //
+        for (U32 bone = 0; bone < num_bones; ++bone) {
+            A_Sample *a = &frame0[bone];
+            A_Sample *b = &frame1[bone];
+
+            for (U32 g = 0; g < count; ++g) {
+                if (lods[g] && !A_BoneMaskTest(&lods[g]->kept, bone)) { continue; }
+
+                F32 t = frames[keys[first + g].index].t;
+                samples[(g * num_bones) + bone] = A_SampleLerp(a, b, t);
+            }
+        }
+
+        // each instance has its own range of the output palette so no synchronisation is needed when writing
+        //
+        for (U32 g = 0; g < count; ++g) {
+            U32 index = keys[first + g].index;
+            A_AnimationBoneMatricesGet(&work->output_palette[work->offsets[index]], skeleton, &samples[g * num_bones], 0, work->instances[index].lod);
+        }
+
+        TempRelease(&group);
+    }
+
+    TempRelease(&temp);
+}
+
+// Evaluates each instance at the frame pair provided into output_palette at its offset, the playback of each
+// instance must have already been advanced
+//
+FileScope void A_BatchRun(Mat3x4F *output_palette, A_Instance *instances, A_FramePair *frames, U64 *offsets, U32 num_instances) {
+    if (num_instances == 0) { return; }
+
+    TempArena temp = TempGet(0, 0);
+
+    A_BatchKey *keys    = ArenaPush(temp.arena, A_BatchKey, num_instances, ARENA_FLAG_NO_ZERO);
+    A_BatchKey *scratch = ArenaPush(temp.arena, A_BatchKey, num_instances, ARENA_FLAG_NO_ZERO);
+
+    // there are generally very few unique skeletons in a batch so a linear search is fine here
+    //
+    U32 num_skeletons = 0;
+    A_Skeleton **skeletons = ArenaPush(temp.arena, A_Skeleton *, num_instances, ARENA_FLAG_NO_ZERO);
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        A_Instance *instance = &instances[it];
+        A_Skeleton *skeleton = instance->skeleton;
+        A_Playback *playback = &instance->playback;
+
+        U32 slot = 0;
+        while (slot < num_skeletons && skeletons[slot] != skeleton) { slot += 1; }
+
+        if (slot == num_skeletons) {
+            skeletons[num_skeletons] = skeleton;
+            num_skeletons += 1;
+        }
+
+        Assert(slot < (1 << 16));
+        Assert(playback->animation_index < (1 << 23));
+        Assert(frames[it].index0 < (1 << 24));
+
+        U64 wrapped = (frames[it].index1 < frames[it].index0) ? 1 : 0;
+
+        keys[it].key   = (cast(U64) slot << 48) | (cast(U64) playback->animation_index << 25) | (wrapped << 24) | frames[it].index0;
+        keys[it].index = it;
+    }
+
+    A_BatchKeysSort(keys, scratch, num_instances);
+
+    // find the start of each group, groups[num_groups] is the end of the final group
+    //
+    U32  num_groups = 0;
+    U32 *groups     = ArenaPush(temp.arena, U32, num_instances + 1, ARENA_FLAG_NO_ZERO);
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        if (it == 0 || keys[it].key != keys[it - 1].key) {
+            groups[num_groups] = it;
+            num_groups += 1;
+        }
+    }
+
+    groups[num_groups] = num_instances;
+
+    // split the groups into contiguous runs of roughly equal instance count, a few per thread so threads that
+    // finish early can steal the remaining work
+    //
+    U32 num_threads = JobWorkerCount() + 1;
+    U32 num_work    = Min(num_groups, 4 * num_threads);
+    U32 per_work    = (num_instances + num_work - 1) / num_work;
+
+    A_BatchWork *work = ArenaPush(temp.arena, A_BatchWork, num_work);
+
+    JobCounter counter = { 0 };
+
+    U32 group = 0;
+    for (U32 it = 0; it < num_work && group < num_groups; ++it) {
+        A_BatchWork *w = &work[it];
+
+        w->output_palette = output_palette;
+        w->instances      = instances;
+        w->keys           = keys;
+        w->frames         = frames;
+        w->offsets        = offsets;
+        w->groups         = groups;
+        w->first_group    = group;
+
+        U32 target = groups[group] + per_work;
+        while (group < num_groups && groups[group] < target) { group += 1; }
+
+        w->last_group = group;
+
+        JobPush(A_BatchWorkRun, w, &counter);
+    }
+
+    Assert(group == num_groups);
+
+    JobCounterWait(&counter);
+
+    TempRelease(&temp);
+}
+
+void A_AnimationEvaluateBatch(Mat3x4F *output_palette, A_Instance *instances, U32 num_instances, F32 dt) {
+    if (num_instances == 0) { return; }
+
+    TempArena temp = TempGet(0, 0);
+
+    A_FramePair *frames  = ArenaPush(temp.arena, A_FramePair, num_instances, ARENA_FLAG_NO_ZERO);
+    U64         *offsets = ArenaPush(temp.arena, U64,         num_instances, ARENA_FLAG_NO_ZERO);
+
+    U64 palette_offset = 0;
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        A_Instance *instance = &instances[it];
+        A_Skeleton *skeleton = instance->skeleton;
+        A_Playback *playback = &instance->playback;
+
+        A_PlaybackAdvance(playback, skeleton, dt);
+
+        A_Animation *animation = &skeleton->animations[playback->animation_index];
+        frames[it] = A_AnimationFramePairGet(animation, skeleton->framerate, playback->time, playback->loop_mode);
+
+        offsets[it]     = palette_offset;
+        palette_offset += skeleton->num_bones;
+    }
+
+    A_BatchRun(output_palette, instances, frames, offsets, num_instances);
+
+    TempRelease(&temp);
+}
+
+A_PoseCache A_PoseCacheCreate(Arena *arena, A_Instance *instances, U32 num_instances, U32 quantisation) {
+    A_PoseCache result = { 0 };
+
+    result.quantisation = quantisation;
+    result.capacity     = A_InstancesPaletteCount(instances, num_instances);
+    result.palette      = ArenaPush(arena, Mat3x4F, result.capacity, ARENA_FLAG_NO_ZERO);
+
+    return result;
+}
+
+// Everything that affects the palette produced for an instance, the struct has no padding so keys can be compared
+// with MemoryCompare
+//
+typedef struct A_PoseCacheKey A_PoseCacheKey;
+struct A_PoseCacheKey {
+    A_Skeleton *skeleton;
+
+    U32 animation_index;
+    U32 index0;
+    U32 index1;
+    U32 t; // quantised, or the bits of t if there is no quantisation
+    U32 lod;
+    U32 pad;
+};
+
+StaticAssert(sizeof(A_PoseCacheKey) == 32);
+
+FileScope U64 A_PoseCacheKeyHash(A_PoseCacheKey *key) {
+    U64 result = cast(U64) key->skeleton;
+
+    U32 values[] = { key->animation_index, key->index0, key->index1, key->t, key->lod };
+
+    for (U32 it = 0; it < ArraySize(values); ++it) {
+        result ^= values[it];
+        result *= 0x9E3779B97F4A7C15ULL;
+        result ^= (result >> 32);
+    }
+
+    return result;
+}
+
+void A_AnimationEvaluateCached(U64 *palette_offsets, A_PoseCache *cache, A_Instance *instances, U32 num_instances, F32 dt) {
+    cache->num_poses     = 0;
+    cache->palette_count = 0;
+    cache->frame_lookups = num_instances;
+    cache->frame_hits    = 0;
+
+    if (num_instances == 0) { return; }
+
+    TempArena temp = TempGet(0, 0);
+
+    // open addressing with linear probing, the table is always at most half full
+    //
+    U32 table_size = 1;
+    while (table_size < (2 * num_instances)) { table_size <<= 1; }
+
+    U32 *table = ArenaPush(temp.arena, U32, table_size, ARENA_FLAG_NO_ZERO);
+    for (U32 it = 0; it < table_size; ++it) { table[it] = U32_MAX; }
+
+    A_PoseCacheKey *keys    = ArenaPush(temp.arena, A_PoseCacheKey, num_instances, ARENA_FLAG_NO_ZERO);
+    A_Instance     *poses   = ArenaPush(temp.arena, A_Instance,     num_instances, ARENA_FLAG_NO_ZERO);
+    A_FramePair    *frames  = ArenaPush(temp.arena, A_FramePair,    num_instances, ARENA_FLAG_NO_ZERO);
+    U64            *offsets = ArenaPush(temp.arena, U64,            num_instances, ARENA_FLAG_NO_ZERO);
+
+    U32 num_poses     = 0;
+    U64 palette_count = 0;
+    U32 num_hits      = 0;
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        A_Instance *instance = &instances[it];
+        A_Skeleton *skeleton = instance->skeleton;
+        A_Playback *playback = &instance->playback;
+
+        A_PlaybackAdvance(playback, skeleton, dt);
+
+        A_Animation *animation = &skeleton->animations[playback->animation_index];
+        A_FramePair  pair      = A_AnimationFramePairGet(animation, skeleton->framerate, playback->time, playback->loop_mode);
+
+        A_PoseCacheKey key;
+        key.skeleton        = skeleton;
+        key.animation_index = playback->animation_index;
+        key.index0          = pair.index0;
+        key.index1          = pair.index1;
+        key.lod             = A_SkeletonLodGet(skeleton, instance->lod) ? Min(instance->lod, skeleton->num_lods - 1) : 0;
+        key.pad             = 0;
+
+        if (cache->quantisation != 0) {
+            key.t  = cast(U32) ((pair.t * cache->quantisation) + 0.5f);
+            pair.t = cast(F32) key.t / cast(F32) cache->quantisation;
+        }
+        else {
+            MemoryCopy(&key.t, &pair.t, sizeof(U32));
+        }
+
+        U32 mask = table_size - 1;
+        U32 slot = cast(U32) A_PoseCacheKeyHash(&key) & mask;
+
+        while (table[slot] != U32_MAX && !MemoryCompare(&keys[table[slot]], &key, sizeof(A_PoseCacheKey))) {
+            slot = (slot + 1) & mask;
+        }
+
+        U32 pose = table[slot];
+        if (pose == U32_MAX) {
+            pose = num_poses;
+
+            keys[pose]    = key;
+            poses[pose]   = *instance;
+            frames[pose]  = pair;
+            offsets[pose] = palette_count;
+
+            poses[pose].lod = key.lod;
+
+            table[slot]    = pose;
+            num_poses     += 1;
+            palette_count += skeleton->num_bones;
+        }
+        else {
+            num_hits += 1;
+        }
+
+        palette_offsets[it] = offsets[pose];
+    }
+
+    Assert(palette_count <= cache->capacity);
+
+    A_BatchRun(cache->palette, poses, frames, offsets, num_poses);
+
+    cache->num_poses     = num_poses;
+    cache->palette_count = palette_count;
+    cache->frame_hits    = num_hits;
+
+    cache->total_lookups += num_instances;
+    cache->total_hits    += num_hits;
+
+    TempRelease(&temp);
+}
+
+A_UpdateScheduler A_UpdateSchedulerCreate(Arena *arena, A_Instance *instances, U32 num_instances, F32 budget_us, F32 near_distance) {
+    A_UpdateScheduler result = { 0 };
+
+    result.blend         = A_UPDATE_BLEND_EXTRAPOLATE;
+    result.budget_us     = budget_us;
+    result.near_distance = near_distance;
+
+    result.num_instances = num_instances;
+    result.palette_count = A_InstancesPaletteCount(instances, num_instances);
+
+    result.states  = ArenaPush(arena, A_UpdateState, num_instances);
+    result.offsets = ArenaPush(arena, U64, num_instances, ARENA_FLAG_NO_ZERO);
+
+    U64 offset = 0;
+    for (U32 it = 0; it < num_instances; ++it) {
+        result.states[it].rate = 1;
+        result.offsets[it]     = offset;
+
+        offset += instances[it].skeleton->num_bones;
+    }
+
+    U32 alignment = WIDE_MAX_LANES * sizeof(F32);
+
+    result.last     = ArenaPush(arena, Mat3x4F, result.palette_count, ARENA_FLAG_NO_ZERO, alignment);
+    result.previous = ArenaPush(arena, Mat3x4F, result.palette_count, ARENA_FLAG_NO_ZERO, alignment);
+
+    return result;
+}
+
+// (previous + ((last - previous) * t)) for count matrices
+//
+// the palette for an instance can start at any multiple of 48 bytes, so the first and last few values are blended
+// one at a time until the rest are aligned for the wide loads. all three palettes are at the same offset from an
+// aligned base so they are aligned at the same point
+//
+FileScope void A_PaletteBlend(Mat3x4F *output, Mat3x4F *previous, Mat3x4F *last, U32 count, F32 t) {
+    F32 *o = output->e;
+    F32 *a = previous->e;
+    F32 *b = last->e;
+
+    U32 total = 12 * count;
+    U32 it    = 0;
+
+    U64 align_mask = (WIDE_LANES * sizeof(F32)) - 1;
+
+    for (; it < total && (cast(U64) &o[it] & align_mask); ++it) {
+        o[it] = a[it] + ((b[it] - a[it]) * t);
+    }
+
+    WideF32 wide_t = WideF32Set1(t);
+
+    for (; (it + WIDE_LANES) <= total; it += WIDE_LANES) {
+        WideF32 x = WideF32Load(&a[it]);
+        WideF32 y = WideF32Load(&b[it]);
+
+        WideF32Store(&o[it], WideF32Add(x, WideF32Mul(WideF32Sub(y, x), wide_t)));
+    }
+
+    for (; it < total; ++it) {
+        o[it] = a[it] + ((b[it] - a[it]) * t);
+    }
+}
+
+void A_UpdateSchedulerEvaluate(Mat3x4F *output_palette, A_UpdateScheduler *scheduler, A_Instance *instances, F32 dt, Vec3F view_p) {
+    Assert((cast(U64) output_palette & ((WIDE_MAX_LANES * sizeof(F32)) - 1)) == 0);
+
+    U32 num_instances = scheduler->num_instances;
+    if (num_instances == 0) { return; }
+
+    TempArena temp = TempGet(0, 0);
+
+    A_BatchKey *keys    = ArenaPush(temp.arena, A_BatchKey, num_instances, ARENA_FLAG_NO_ZERO);
+    A_BatchKey *scratch = ArenaPush(temp.arena, A_BatchKey, num_instances, ARENA_FLAG_NO_ZERO);
+
+    U32 num_due       = 0;
+    U32 num_mandatory = 0;
+
+    for (U32 it = 0; it < ArraySize(scheduler->num_at_rate); ++it) { scheduler->num_at_rate[it] = 0; }
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        A_UpdateState *state = &scheduler->states[it];
+
+        Vec3F offset   = V3FAdd(instances[it].position, V3FNeg(view_p));
+        F32   distance = F32Sqrt(V3FDot(offset, offset));
+
+        U32 rate  = 1;
+        U32 shift = 0;
+        for (F32 d = scheduler->near_distance; distance >= d && rate < A_UPDATE_MAX_RATE; d *= 2.0f) {
+            rate  <<= 1;
+            shift  += 1;
+        }
+
+        state->rate          = rate;
+        state->frames_since += 1;
+        state->dt           += dt;
+
+        scheduler->num_at_rate[shift] += 1;
+
+        // instances are staggered by their index so each frame only sees (1 / rate) of the instances at each rate
+        // become due, instances that missed their slot because of the budget stay due until they are updated
+        //
+        B32 slot = ((scheduler->frame + it) & (rate - 1)) == 0;
+        if (slot || state->frames_since > rate || state->num_updates == 0) {
+            // sorted so instances without a palette come first, then the most overdue relative to their rate and
+            // then the closest
+            //
+            U32 overdue = (state->num_updates == 0) ? U16_MAX : Min((state->frames_since << 8) / rate, U16_MAX - 1);
+
+            F32 key_distance = distance;
+            U32 distance_bits;
+            MemoryCopy(&distance_bits, &key_distance, sizeof(U32));
+
+            keys[num_due].key   = (cast(U64) (U16_MAX - overdue) << 32) | distance_bits;
+            keys[num_due].index = it;
+
+            num_due       += 1;
+            num_mandatory += (state->num_updates == 0) ? 1 : 0;
+        }
+    }
+
+    U32 num_updates = num_due;
+    if (scheduler->budget_us > 0 && scheduler->cost_us > 0) {
+        U32 allowed = cast(U32) (scheduler->budget_us / scheduler->cost_us);
+        num_updates = Min(num_due, Max(allowed, num_mandatory));
+    }
+
+    if (num_updates < num_due) {
+        A_BatchKeysSort(keys, scratch, num_due);
+    }
+
+    scheduler->num_updated  = num_updates;
+    scheduler->num_deferred = num_due - num_updates;
+    scheduler->update_us    = 0;
+
+    if (num_updates != 0) {
+        // the updated instances are copied out so they can be evaluated as a single batch, each is advanced by the
+        // time accumulated since its own last update first so the batch itself doesn't advance them
+        //
+        A_Instance *batch   = ArenaPush(temp.arena, A_Instance, num_updates, ARENA_FLAG_NO_ZERO);
+        U64        *offsets = ArenaPush(temp.arena, U64, num_updates, ARENA_FLAG_NO_ZERO);
+
+        U64 batch_count = 0;
+
+        for (U32 it = 0; it < num_updates; ++it) {
+            U32 index = keys[it].index;
+            A_UpdateState *state = &scheduler->states[index];
+
+            batch[it] = instances[index];
+            A_PlaybackAdvance(&batch[it].playback, batch[it].skeleton, state->dt);
+
+            offsets[it]  = batch_count;
+            batch_count += batch[it].skeleton->num_bones;
+        }
+
+        Mat3x4F *palette = ArenaPush(temp.arena, Mat3x4F, batch_count, ARENA_FLAG_NO_ZERO);
+
+        U64 start = U64TicksGet();
+        A_AnimationEvaluateBatch(palette, batch, num_updates, 0);
+        U64 end = U64TicksGet();
+
+        F32 update_us = cast(F32) (1000000.0 * F64ElapsedTimeGet(start, end));
+        F32 cost_us   = update_us / num_updates;
+
+        scheduler->update_us = update_us;
+        scheduler->cost_us   = (scheduler->cost_us > 0) ? ((0.9f * scheduler->cost_us) + (0.1f * cost_us)) : cost_us;
+
+        for (U32 it = 0; it < num_updates; ++it) {
+            U32 index = keys[it].index;
+
+            A_UpdateState *state = &scheduler->states[index];
+            A_Instance    *instance = &instances[index];
+
+            instance->playback = batch[it].playback;
+
+            U64 offset    = scheduler->offsets[index];
+            U32 num_bones = instance->skeleton->num_bones;
+
+            MemoryCopy(&scheduler->previous[offset], &scheduler->last[offset], num_bones * sizeof(Mat3x4F));
+            MemoryCopy(&scheduler->last[offset], &palette[offsets[it]], num_bones * sizeof(Mat3x4F));
+
+            state->interval     = state->dt;
+            state->dt           = 0;
+            state->frames_since = 0;
+            state->num_updates  = Min(state->num_updates + 1, 2);
+        }
+    }
+
+    for (U32 it = 0; it < num_instances; ++it) {
+        A_UpdateState *state = &scheduler->states[it];
+
+        U64 offset    = scheduler->offsets[it];
+        U32 num_bones = instances[it].skeleton->num_bones;
+
+        Mat3x4F *output = &output_palette[offset];
+
+        // extrapolation is limited to a single interval past the last update so instances that are held back by
+        // the budget don't drift too far
+        //
+        F32 t = 1.0f;
+        if (state->num_updates == 2 && state->interval > 0) {
+            t = Clamp01(state->dt / state->interval);
+            if (scheduler->blend == A_UPDATE_BLEND_EXTRAPOLATE) { t += 1.0f; }
+        }
+
+        if (t == 1.0f) {
+            MemoryCopy(output, &scheduler->last[offset], num_bones * sizeof(Mat3x4F));
+        }
+        else if (t == 0.0f) {
+            MemoryCopy(output, &scheduler->previous[offset], num_bones * sizeof(Mat3x4F));
+        }
+        else {
+            A_PaletteBlend(output, &scheduler->previous[offset], &scheduler->last[offset], num_bones, t);
+        }
+    }
+
+    scheduler->frame += 1;
+
+    TempRelease(&temp);
+}
+
+// Full precision frames are stored exactly as a palette
+//
+FileScope void A_BakedMatricesStore(U8 *output, Mat3x4F *matrices, U32 num_bones, A_BakeFlags flags) {
+    if (flags & A_BAKE_FLAG_HALF) {
+        U16 *values = cast(U16 *) output;
+
+        for (U32 it = 0; it < num_bones; ++it) {
+            for (U32 e = 0; e < 12; ++e) {
+                values[e] = F32ToF16(matrices[it].e[e]);
+            }
+
+            values += 12;
+        }
+    }
+    else {
+        MemoryCopy(output, matrices, num_bones * sizeof(Mat3x4F));
+    }
+}
+
+A_BakedClips A_SkeletonBake(Arena *arena, A_Skeleton *skeleton, A_BakeFlags flags) {
+    A_BakedClips result = { 0 };
+
+    result.flags     = flags;
+    result.framerate = skeleton->framerate;
+    result.num_bones = skeleton->num_bones;
+    result.num_clips = skeleton->num_animations;
+
+    result.matrix_size  = (flags & A_BAKE_FLAG_HALF) ? (12 * sizeof(U16)) : sizeof(Mat3x4F);
+    result.frame_stride = cast(U64) result.num_bones * result.matrix_size;
+
+    result.clips = ArenaPush(arena, A_BakedClip, result.num_clips);
+
+    for (U32 it = 0; it < result.num_clips; ++it) {
+        A_BakedClip *clip = &result.clips[it];
+
+        clip->first_frame = result.total_frames;
+        clip->num_frames  = skeleton->animations[it].num_frames;
+
+        result.total_frames += clip->num_frames;
+    }
+
+    result.size = result.total_frames * result.frame_stride;
+    result.data = ArenaPush(arena, U8, result.size, ARENA_FLAG_NO_ZERO, 64);
+
+    TempArena temp = TempGet(1, &arena);
+
+    A_Sample *samples  = ArenaPush(temp.arena, A_Sample, skeleton->num_bones, ARENA_FLAG_NO_ZERO);
+    Mat3x4F  *matrices = ArenaPush(temp.arena, Mat3x4F,  skeleton->num_bones, ARENA_FLAG_NO_ZERO);
+
+    A_Cursor *cursor = A_CursorPush(temp.arena, skeleton);
+
+    // frames are decoded directly rather than sampled by time so each one is exact, the cursor makes walking the
+    // sparse channels in order linear
+    //
+    U8 *output = result.data;
+
+    for (U32 c = 0; c < result.num_clips; ++c) {
+        A_Animation *animation = &skeleton->animations[c];
+
+        for (U32 it = 0; it < animation->num_frames; ++it) {
+            A_AnimationFrameDecode(samples, animation, skeleton->num_bones, it, cursor);
+            A_AnimationBoneMatricesGet(matrices, skeleton, samples, 0, 0);
+
+            A_BakedMatricesStore(output, matrices, skeleton->num_bones, flags);
+            output += result.frame_stride;
+        }
+    }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+U32 A_BakedFrameIndexGet(A_BakedClips *baked, U32 clip_index, U32 frame_index) {
+    Assert(clip_index < baked->num_clips);
+
+    A_BakedClip *clip = &baked->clips[clip_index];
+
+    U32 result = clip->first_frame + Min(frame_index, clip->num_frames - 1);
+    return result;
+}
+
+void A_BakedMatricesGet(Mat3x4F *output_matrices, A_BakedClips *baked, U32 table_frame) {
+    Assert(table_frame < baked->total_frames);
+
+    U8 *input = baked->data + (table_frame * baked->frame_stride);
+
+    if (baked->flags & A_BAKE_FLAG_HALF) {
+        U16 *values = cast(U16 *) input;
+
+        for (U32 it = 0; it < baked->num_bones; ++it) {
+            for (U32 e = 0; e < 12; ++e) {
+                output_matrices[it].e[e] = F16ToF32(values[e]);
+            }
+
+            values += 12;
+        }
+    }
+    else {
+        MemoryCopy(output_matrices, input, baked->num_bones * sizeof(Mat3x4F));
+    }
+}
+
+void A_AnimationEvaluateBaked(U32 *output_frames, A_BakedClips *baked, A_Instance *instances, U32 num_instances, F32 dt) {
+    for (U32 it = 0; it < num_instances; ++it) {
+        A_Instance *instance = &instances[it];
+        A_Skeleton *skeleton = instance->skeleton;
+        A_Playback *playback = &instance->playback;
+
+        Assert(skeleton->num_bones == baked->num_bones && skeleton->num_animations == baked->num_clips);
+
+        A_PlaybackAdvance(playback, skeleton, dt);
+
+        A_Animation *animation = &skeleton->animations[playback->animation_index];
+        A_FramePair  frames    = A_AnimationFramePairGet(animation, skeleton->framerate, playback->time, playback->loop_mode);
+
+        U32 frame = (frames.t < 0.5f) ? frames.index0 : frames.index1;
+        output_frames[it] = baked->clips[playback->animation_index].first_frame + frame;
+    }
+}
+
+A_BlendGraph A_BlendGraphCreate(Arena *arena, A_Skeleton *skeleton, U32 max_nodes) {
+    A_BlendGraph result;
+
+    result.arena    = arena;
+    result.skeleton = skeleton;
+
+    result.num_nodes = 0;
+    result.max_nodes = max_nodes;
+    result.nodes     = ArenaPush(arena, A_BlendNode, max_nodes);
+
+    return result;
+}
+
+FileScope U32 A_BlendNodeAdd(A_BlendGraph *graph, A_BlendNodeType type, U32 *inputs, U32 num_inputs, U32 param) {
+    Assert(graph->num_nodes < graph->max_nodes);
+
+    U32 result = graph->num_nodes;
+    graph->num_nodes += 1;
+
+    A_BlendNode *node = &graph->nodes[result];
+
+    node->type       = type;
+    node->param      = param;
+    node->num_inputs = num_inputs;
+    node->inputs     = num_inputs ? ArenaPushCopy(graph->arena, inputs, U32, num_inputs) : 0;
+
+    // inputs must already exist so the nodes are always in dependency order
+    //
+    for (U32 it = 0; it < num_inputs; ++it) {
+        Assert(inputs[it] < result);
+    }
+
+    return result;
+}
+
+U32 A_BlendClipAdd(A_BlendGraph *graph, U32 animation_index, A_LoopMode loop_mode) {
+    Assert(animation_index < graph->skeleton->num_animations);
+
+    U32 result = A_BlendNodeAdd(graph, A_BLEND_NODE_CLIP, 0, 0, 0);
+
+    A_BlendNode *node = &graph->nodes[result];
+
+    node->animation_index = animation_index;
+    node->loop_mode       = loop_mode;
+
+    return result;
+}
+
+U32 A_BlendLerpAdd(A_BlendGraph *graph, U32 a, U32 b, U32 param) {
+    U32 inputs[] = { a, b };
+
+    U32 result = A_BlendNodeAdd(graph, A_BLEND_NODE_LERP, inputs, ArraySize(inputs), param);
+    return result;
+}
+
+U32 A_BlendAdditiveAdd(A_BlendGraph *graph, U32 base, U32 additive, U32 reference, U32 param) {
+    U32 inputs[] = { base, additive, reference };
+    U32 count    = (reference == A_BLEND_NODE_NONE) ? 2 : 3;
+
+    U32 result = A_BlendNodeAdd(graph, A_BLEND_NODE_ADDITIVE, inputs, count, param);
+    return result;
+}
+
+U32 A_BlendSpaceAdd(A_BlendGraph *graph, U32 *inputs, F32 *positions, U32 count, U32 param) {
+    Assert(count != 0);
+
+    for (U32 it = 1; it < count; ++it) {
+        Assert(positions[it - 1] < positions[it]);
+    }
+
+    U32 result = A_BlendNodeAdd(graph, A_BLEND_NODE_BLEND_SPACE, inputs, count, param);
+
+    graph->nodes[result].positions = ArenaPushCopy(graph->arena, positions, F32, count);
+
+    return result;
+}
+
+U32 A_BlendLayerAdd(A_BlendGraph *graph, U32 base, U32 layer, F32 *bone_weights, U32 param) {
+    U32 inputs[] = { base, layer };
+
+    U32 result = A_BlendNodeAdd(graph, A_BLEND_NODE_LAYER, inputs, ArraySize(inputs), param);
+
+    graph->nodes[result].bone_weights = ArenaPushCopy(graph->arena, bone_weights, F32, graph->skeleton->num_bones);
+
+    return result;
+}
+
+A_BlendTree A_BlendTreeCreate(Arena *arena, A_BlendGraph *graph, U32 root) {
+    A_BlendTree result = { 0 };
+
+    Assert(root < graph->num_nodes);
+
+    A_Skeleton *skeleton = graph->skeleton;
+    A_BlendNode *nodes   = graph->nodes;
+
+    TempArena temp = TempGet(1, &arena);
+
+    // nodes only reference nodes before them so walking backwards from the root finds everything that is needed,
+    // and the last op to read the output of each node
+    //
+    B32 *used      = ArenaPush(temp.arena, B32, root + 1);
+    U32 *last_use  = ArenaPush(temp.arena, U32, root + 1);
+    U32 *registers = ArenaPush(temp.arena, U32, root + 1);
+
+    used[root] = true;
+
+    U32 num_inputs    = 0;
+    U32 num_positions = 0;
+    U32 num_layers    = 0;
+
+    for (U32 it = root + 1; it-- > 0;) {
+        A_BlendNode *node = &nodes[it];
+        if (!used[it]) { continue; }
+
+        result.num_ops += 1;
+
+        num_inputs += node->num_inputs;
+        result.max_inputs = Max(result.max_inputs, node->num_inputs);
+
+        switch (node->type) {
+            case A_BLEND_NODE_CLIP:        { result.num_clips += 1;                } break;
+            case A_BLEND_NODE_BLEND_SPACE: { num_positions    += node->num_inputs; } break;
+            case A_BLEND_NODE_LAYER:       { num_layers       += 1;                } break;
+        }
+
+        if (node->type != A_BLEND_NODE_CLIP) {
+            result.num_params = Max(result.num_params, node->param + 1);
+        }
+
+        for (U32 in = 0; in < node->num_inputs; ++in) {
+            U32 input = node->inputs[in];
+
+            if (!used[input]) {
+                used[input]     = true;
+                last_use[input] = it;
+            }
+        }
+    }
+
+    U32 capacity  = cast(U32) AlignUp(skeleton->num_bones, WIDE_MAX_LANES);
+    U32 alignment = WIDE_MAX_LANES * sizeof(F32);
+
+    result.skeleton = skeleton;
+
+    result.ops    = ArenaPush(arena, A_BlendOp, result.num_ops);
+    result.inputs = ArenaPush(arena, U32, num_inputs);
+
+    result.clips      = ArenaPush(arena, A_Playback, result.num_clips);
+    result.clip_nodes = ArenaPush(arena, U32, result.num_clips);
+
+    result.params       = ArenaPush(arena, F32, result.num_params);
+    result.positions    = ArenaPush(arena, F32, num_positions);
+    result.weights      = ArenaPush(arena, F32, num_positions);
+    result.bone_weights = ArenaPush(arena, F32, num_layers * capacity, 0, alignment);
+
+    // registers are assigned in op order and released after the last op that reads them, outputs can reuse the
+    // register of one of their own inputs as all of the kernels read every input for a block of bones before
+    // writing. register 0 is reserved for the root
+    //
+    U32 *free_registers = ArenaPush(temp.arena, U32, result.num_ops);
+    U32  num_free       = 0;
+
+    U32 *op_nodes = ArenaPush(temp.arena, U32, result.num_ops);
+    U32 *node_ops = ArenaPush(temp.arena, U32, root + 1);
+
+    result.num_registers = 1;
+
+    U32 op_index = 0;
+
+    num_inputs    = 0;
+    num_positions = 0;
+    num_layers    = 0;
+
+    U32 num_clips = 0;
+
+    for (U32 it = 0; it <= root; ++it) {
+        A_BlendNode *node = &nodes[it];
+        if (!used[it]) { continue; }
+
+        A_BlendOp *op = &result.ops[op_index];
+
+        op_nodes[op_index] = it;
+        node_ops[it]       = op_index;
+
+        op_index += 1;
+
+        op->type        = node->type;
+        op->first_input = num_inputs;
+        op->num_inputs  = node->num_inputs;
+        op->param       = node->param;
+        op->data        = 0;
+
+        for (U32 in = 0; in < node->num_inputs; ++in) {
+            result.inputs[num_inputs] = registers[node->inputs[in]];
+            num_inputs += 1;
+        }
+
+        switch (node->type) {
+            case A_BLEND_NODE_CLIP: {
+                A_Playback *playback = &result.clips[num_clips];
+
+                *playback = A_PlaybackCreate(node->animation_index, node->loop_mode);
+                playback->cursor = A_CursorPush(arena, skeleton);
+
+                result.clip_nodes[num_clips] = it;
+
+                op->data   = num_clips;
+                num_clips += 1;
+            }
+            break;
+            case A_BLEND_NODE_BLEND_SPACE: {
+                MemoryCopy(&result.positions[num_positions], node->positions, node->num_inputs * sizeof(F32));
+
+                op->data       = num_positions;
+                num_positions += node->num_inputs;
+            }
+            break;
+            case A_BLEND_NODE_LAYER: {
+                // padding is left at zero so it always keeps the base pose
+                //
+                MemoryCopy(&result.bone_weights[num_layers * capacity], node->bone_weights, skeleton->num_bones * sizeof(F32));
+
+                op->data    = num_layers * capacity;
+                num_layers += 1;
+            }
+            break;
+        }
+
+        for (U32 in = 0; in < node->num_inputs; ++in) {
+            U32 input = node->inputs[in];
+
+            // checking the register as well stops inputs that are used more than once by this op being freed twice
+            //
+            if (last_use[input] == it && registers[input] != U32_MAX) {
+                free_registers[num_free] = registers[input];
+                num_free += 1;
+
+                registers[input] = U32_MAX;
+            }
+        }
+
+        if (it == root) {
+            op->output = 0;
+        }
+        else if (num_free != 0) {
+            num_free  -= 1;
+            op->output = free_registers[num_free];
+        }
+        else {
+            op->output = result.num_registers;
+            result.num_registers += 1;
+        }
+
+        registers[it] = op->output;
+    }
+
+    Assert(op_index == result.num_ops);
+
+    // the bones needed from each op are pushed down from the root, which needs every bone
+    //
+    A_BoneMask needed = A_BoneMaskPush(temp.arena, skeleton->num_bones);
+    A_BoneMask layer  = A_BoneMaskPush(temp.arena, skeleton->num_bones);
+
+    U32 num_words = needed.num_words;
+
+    result.mask_words = num_words;
+    result.masks      = ArenaPush(arena, U64, result.num_ops * num_words);
+
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        A_BoneMaskSet(&needed, it);
+    }
+
+    MemoryCopy(&result.masks[(result.num_ops - 1) * num_words], needed.bits, num_words * sizeof(U64));
+
+    for (U32 it = result.num_ops; it-- > 0;) {
+        A_BlendNode *node = &nodes[op_nodes[it]];
+        U64         *bits = &result.masks[it * num_words];
+
+        if (node->type == A_BLEND_NODE_LAYER) {
+            for (U32 w = 0; w < num_words; ++w) { layer.bits[w] = 0; }
+
+            for (U32 bone = 0; bone < skeleton->num_bones; ++bone) {
+                if (node->bone_weights[bone] != 0) { A_BoneMaskSet(&layer, bone); }
+            }
+        }
+
+        for (U32 in = 0; in < node->num_inputs; ++in) {
+            U64 *input_bits = &result.masks[node_ops[node->inputs[in]] * num_words];
+            B32  is_layer   = (node->type == A_BLEND_NODE_LAYER) && (in == 1);
+
+            for (U32 w = 0; w < num_words; ++w) {
+                input_bits[w] |= is_layer ? (bits[w] & layer.bits[w]) : bits[w];
+            }
+        }
+    }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+void A_BlendTreeParamSet(A_BlendTree *tree, U32 param, F32 value) {
+    Assert(param < tree->num_params);
+    tree->params[param] = value;
+}
+
+A_Playback *A_BlendTreePlaybackGet(A_BlendTree *tree, U32 node) {
+    A_Playback *result = 0;
+
+    for (U32 it = 0; it < tree->num_clips; ++it) {
+        if (tree->clip_nodes[it] == node) {
+            result = &tree->clips[it];
+            break;
+        }
+    }
+
+    return result;
+}
+
+void A_BlendTreeEvaluate(A_Pose *output, A_BlendTree *tree, F32 dt, A_BoneMask *mask) {
+    A_Skeleton *skeleton = tree->skeleton;
+
+    Assert(output->num_bones == skeleton->num_bones);
+    Assert(!mask || mask->num_words == tree->mask_words);
+
+    TempArena temp = TempGet(0, 0);
+
+    A_BoneMask op_mask = A_BoneMaskPush(temp.arena, skeleton->num_bones);
+
+    A_Pose  *registers = ArenaPush(temp.arena, A_Pose,   tree->num_registers, ARENA_FLAG_NO_ZERO);
+    A_Pose **inputs    = ArenaPush(temp.arena, A_Pose *, tree->max_inputs,    ARENA_FLAG_NO_ZERO);
+
+    registers[0] = *output;
+
+    for (U32 it = 1; it < tree->num_registers; ++it) {
+        registers[it] = A_PosePush(temp.arena, skeleton->num_bones);
+    }
+
+    for (U32 it = 0; it < tree->num_ops; ++it) {
+        A_BlendOp *op  = &tree->ops[it];
+        A_Pose    *out = &registers[op->output];
+
+        for (U32 in = 0; in < op->num_inputs; ++in) {
+            inputs[in] = &registers[tree->inputs[op->first_input + in]];
+        }
+
+        U64 *bits = &tree->masks[it * tree->mask_words];
+
+        for (U32 w = 0; w < tree->mask_words; ++w) {
+            op_mask.bits[w] = bits[w] & (mask ? mask->bits[w] : U64_MAX);
+        }
+
+        F32 param = (op->type == A_BLEND_NODE_CLIP) ? 0 : tree->params[op->param];
+
+        switch (op->type) {
+            case A_BLEND_NODE_CLIP: {
+                A_Playback *playback = &tree->clips[op->data];
+
+                A_PlaybackAdvance(playback, skeleton, dt);
+                A_AnimationSamplePose(out, skeleton, playback->animation_index, playback->time, playback->loop_mode, playback->cursor, &op_mask);
+            }
+            break;
+            case A_BLEND_NODE_LERP: {
+                A_PoseLerp(out, inputs[0], inputs[1], Clamp01(param), &op_mask);
+            }
+            break;
+            case A_BLEND_NODE_ADDITIVE: {
+                A_Pose *reference = (op->num_inputs == 3) ? inputs[2] : 0;
+                A_PoseAdditive(out, inputs[0], inputs[1], reference, param, &op_mask);
+            }
+            break;
+            case A_BLEND_NODE_BLEND_SPACE: {
+                F32 *positions = &tree->positions[op->data];
+                F32 *weights   = &tree->weights[op->data];
+
+                U32 count = op->num_inputs;
+                U32 last  = count - 1;
+
+                for (U32 w = 0; w < count; ++w) { weights[w] = 0; }
+
+                param = Clamp(positions[0], param, positions[last]);
+
+                // find the pair of positions either side of the param and weight the two inputs by distance
+                //
+                U32 lower = 0;
+                while (lower + 1 < last && positions[lower + 1] <= param) { lower += 1; }
+
+                if (count == 1) {
+                    weights[0] = 1;
+                }
+                else {
+                    F32 t = (param - positions[lower]) / (positions[lower + 1] - positions[lower]);
+
+                    weights[lower]     = 1 - t;
+                    weights[lower + 1] = t;
+                }
+
+                A_PoseBlend(out, inputs, weights, count, &op_mask);
+            }
+            break;
+            case A_BLEND_NODE_LAYER: {
+                A_PoseLerpMasked(out, inputs[0], inputs[1], &tree->bone_weights[op->data], Clamp01(param), &op_mask);
+            }
+            break;
+        }
+    }
+
+    TempRelease(&temp);
+}
+
+A_Controller A_ControllerCreate(Arena *arena, A_Skeleton *skeleton, U32 animation_index, A_LoopMode loop_mode) {
+    A_Controller result = { 0 };
+
+    Assert(animation_index < skeleton->num_animations);
+
+    result.skeleton = skeleton;
+
+    result.target        = A_PlaybackCreate(animation_index, loop_mode);
+    result.target.cursor = A_CursorPush(arena, skeleton);
+
+    result.source        = A_PlaybackCreate(animation_index, loop_mode);
+    result.source.cursor = A_CursorPush(arena, skeleton);
+
+    result.state = A_TRANSITION_STATE_NONE;
+    result.curve = A_TRANSITION_CURVE_LINEAR;
+
+    result.source_pose = A_PosePush(arena, skeleton->num_bones);
+
+    result.last     = A_PosePush(arena, skeleton->num_bones);
+    result.previous = A_PosePush(arena, skeleton->num_bones);
+
+    result.offset   = A_PosePush(arena, skeleton->num_bones);
+    result.velocity = A_PosePush(arena, skeleton->num_bones);
+
+    return result;
+}
+
+FileScope void A_PoseCopy(A_Pose *output, A_Pose *pose) {
+    Assert(output->capacity == pose->capacity);
+
+    U64 size = pose->capacity * sizeof(F32);
+
+    MemoryCopy(output->px, pose->px, size);
+    MemoryCopy(output->py, pose->py, size);
+    MemoryCopy(output->pz, pose->pz, size);
+
+    MemoryCopy(output->qw, pose->qw, size);
+    MemoryCopy(output->qx, pose->qx, size);
+    MemoryCopy(output->qy, pose->qy, size);
+    MemoryCopy(output->qz, pose->qz, size);
+
+    MemoryCopy(output->sx, pose->sx, size);
+    MemoryCopy(output->sy, pose->sy, size);
+    MemoryCopy(output->sz, pose->sz, size);
+}
+
+// Rotation vector scaled by tan(angle / 2) for the rotation (a * conjugate(b)), this can be scaled towards zero and
+// converted back to a rotation by normalising (1, x, y, z) without needing any trig
+//
+FileScope Vec3F A_RotationOffsetGet(Quat4F a, Quat4F b) {
+    Quat4F q = Q4FMul(a, Q4FConjugate(b));
+    if (q.w < 0) { q = Q4FNeg(q); }
+
+    // rotations of close to half a turn are capped rather than going to infinity
+    //
+    F32 w = Max(q.w, 1e-3f);
+
+    Vec3F result = V3F(q.x / w, q.y / w, q.z / w);
+    return result;
+}
+
+// Offsets that are moving away from zero have their velocity removed so the decay never overshoots further away
+//
+FileScope F32 A_InertializationVelocityClamp(F32 offset, F32 velocity) {
+    F32 result = (offset * velocity > 0) ? 0 : velocity;
+    return result;
+}
+
+FileScope void A_ControllerInertializationStart(A_Controller *controller) {
+    A_Skeleton *skeleton = controller->skeleton;
+    A_Playback *target   = &controller->target;
+
+    TempArena temp = TempGet(0, 0);
+
+    // the new clip where the transition starts and one update before, so the velocity of the new clip can be
+    // removed from the velocity of the output
+    //
+    A_Pose start  = A_PosePush(temp.arena, skeleton->num_bones);
+    A_Pose before = A_PosePush(temp.arena, skeleton->num_bones);
+
+    A_AnimationSamplePose(&start,  skeleton, target->animation_index, target->time, target->loop_mode, 0, 0);
+    A_AnimationSamplePose(&before, skeleton, target->animation_index, target->time - controller->last_dt, target->loop_mode, 0, 0);
+
+    B32 has_velocity = (controller->num_outputs > 1) && (controller->last_dt > 0);
+    F32 inv_dt       = has_velocity ? (1.0f / controller->last_dt) : 0;
+
+    for (U32 it = 0; it < skeleton->num_bones; ++it) {
+        A_Sample last = A_PoseSampleGet(&controller->last, it);
+        A_Sample prev = A_PoseSampleGet(&controller->previous, it);
+        A_Sample s0   = A_PoseSampleGet(&start, it);
+        A_Sample s1   = A_PoseSampleGet(&before, it);
+
+        F32 offset[9];
+        F32 velocity[9];
+
+        Vec3F rotation      = A_RotationOffsetGet(last.orientation, s0.orientation);
+        Vec3F prev_rotation = A_RotationOffsetGet(prev.orientation, s1.orientation);
+
+        for (U32 c = 0; c < 3; ++c) {
+            offset[c + 0] = last.position.e[c] - s0.position.e[c];
+            offset[c + 3] = rotation.e[c];
+            offset[c + 6] = last.scale.e[c] - s0.scale.e[c];
+
+            velocity[c + 0] = (offset[c + 0] - (prev.position.e[c] - s1.position.e[c])) * inv_dt;
+            velocity[c + 3] = (offset[c + 3] - prev_rotation.e[c]) * inv_dt;
+            velocity[c + 6] = (offset[c + 6] - (prev.scale.e[c] - s1.scale.e[c])) * inv_dt;
+        }
+
+        for (U32 c = 0; c < 9; ++c) {
+            velocity[c] = A_InertializationVelocityClamp(offset[c], velocity[c]);
+        }
+
+        // the rotation vectors are stored in the imaginary part of the orientation stream, the real part is unused
+        //
+        A_Sample o = { 0 };
+        A_Sample v = { 0 };
+
+        o.position        = V3F(offset[0], offset[1], offset[2]);
+        o.orientation.xyz = V3F(offset[3], offset[4], offset[5]);
+        o.scale           = V3F(offset[6], offset[7], offset[8]);
+
+        v.position        = V3F(velocity[0], velocity[1], velocity[2]);
+        v.orientation.xyz = V3F(velocity[3], velocity[4], velocity[5]);
+        v.scale           = V3F(velocity[6], velocity[7], velocity[8]);
+
+        A_PoseSampleSet(&controller->offset,   it, &o);
+        A_PoseSampleSet(&controller->velocity, it, &v);
+    }
+
+    TempRelease(&temp);
+}
+
+// Adds (offset * h00) + (velocity * h10) to each bone, orientations are offset by the rotation the scaled rotation
+// vector represents
+//
+FileScope void A_PoseInertializationApply(A_Pose *output, A_Pose *offset, A_Pose *velocity, F32 h00, F32 h10, A_BoneMask *mask) {
+    WideF32 w00 = WideF32Set1(h00);
+    WideF32 w10 = WideF32Set1(h10);
+
+    for (U32 base = 0; base < output->num_bones; base += WIDE_LANES) {
+        U32 bits = A_BoneMaskBlockGet(mask, base);
+        if (!bits) { continue; }
+
+        A_WideSample out = A_WideSampleLoad(output,   base);
+        A_WideSample off = A_WideSampleLoad(offset,   base);
+        A_WideSample vel = A_WideSampleLoad(velocity, base);
+
+        out.px = WideF32Add(out.px, WideF32Add(WideF32Mul(off.px, w00), WideF32Mul(vel.px, w10)));
+        out.py = WideF32Add(out.py, WideF32Add(WideF32Mul(off.py, w00), WideF32Mul(vel.py, w10)));
+        out.pz = WideF32Add(out.pz, WideF32Add(WideF32Mul(off.pz, w00), WideF32Mul(vel.pz, w10)));
+
+        out.sx = WideF32Add(out.sx, WideF32Add(WideF32Mul(off.sx, w00), WideF32Mul(vel.sx, w10)));
+        out.sy = WideF32Add(out.sy, WideF32Add(WideF32Mul(off.sy, w00), WideF32Mul(vel.sy, w10)));
+        out.sz = WideF32Add(out.sz, WideF32Add(WideF32Mul(off.sz, w00), WideF32Mul(vel.sz, w10)));
+
+        WideF32 rw = WideF32Set1(1.0f);
+        WideF32 rx = WideF32Add(WideF32Mul(off.qx, w00), WideF32Mul(vel.qx, w10));
+        WideF32 ry = WideF32Add(WideF32Mul(off.qy, w00), WideF32Mul(vel.qy, w10));
+        WideF32 rz = WideF32Add(WideF32Mul(off.qz, w00), WideF32Mul(vel.qz, w10));
+
+        A_WideQuatNormalize(&rw, &rx, &ry, &rz);
+        A_WideQuatMul(&out.qw, &out.qx, &out.qy, &out.qz, rw, rx, ry, rz, out.qw, out.qx, out.qy, out.qz);
+
+        A_WideSampleStoreMasked(output, base, &out, bits);
+    }
+}
+
+void A_ControllerTransition(A_Controller *controller, U32 animation_index, A_LoopMode loop_mode, F32 duration, A_TransitionCurve curve, A_TransitionFlags flags) {
+    Assert(animation_index < controller->skeleton->num_animations);
+
+    // the current clip becomes the source, the cursors are swapped so each keeps the cursor for its own clip
+    //
+    A_Playback current = controller->target;
+    A_Cursor  *cursor  = controller->source.cursor;
+
+    controller->target        = A_PlaybackCreate(animation_index, loop_mode);
+    controller->target.cursor = cursor;
+
+    controller->duration = duration;
+    controller->elapsed  = 0;
+    controller->curve    = curve;
+
+    if (duration <= 0 || controller->num_outputs == 0) {
+        // nothing has been output yet so there is nothing to transition from
+        //
+        controller->state = A_TRANSITION_STATE_NONE;
+    }
+    else if (flags & A_TRANSITION_FLAG_INERTIALIZE) {
+        A_ControllerInertializationStart(controller);
+        controller->state = A_TRANSITION_STATE_INERTIALIZE;
+    }
+    else if (controller->state == A_TRANSITION_STATE_NONE) {
+        controller->source = current;
+        controller->state  = A_TRANSITION_STATE_CROSS_FADE;
+    }
+    else {
+        // already mid-transition, fade from what was last output rather than sampling a third clip
+        //
+        A_PoseCopy(&controller->source_pose, &controller->last);
+        controller->state = A_TRANSITION_STATE_SNAPSHOT;
+    }
+
+    if (controller->state != A_TRANSITION_STATE_CROSS_FADE) {
+        // the source isn't played so it just holds the unused cursor
+        //
+        controller->source.cursor = current.cursor;
+    }
+}
+
+void A_ControllerEvaluate(A_Pose *output, A_Controller *controller, F32 dt, A_BoneMask *mask) {
+    A_Skeleton *skeleton = controller->skeleton;
+    A_Playback *target   = &controller->target;
+
+    Assert(output->num_bones == skeleton->num_bones);
+
+    A_PlaybackAdvance(target, skeleton, dt);
+    A_AnimationSamplePose(output, skeleton, target->animation_index, target->time, target->loop_mode, target->cursor, mask);
+
+    if (controller->state != A_TRANSITION_STATE_NONE) {
+        controller->elapsed += dt;
+
+        F32 t = Clamp01(controller->elapsed / controller->duration);
+
+        if (controller->state == A_TRANSITION_STATE_INERTIALIZE) {
+            // cubic hermite from the offset and its velocity at the start down to zero with zero velocity at the end
+            //
+            F32 t2 = t  * t;
+            F32 t3 = t2 * t;
+
+            F32 h00 = (2 * t3) - (3 * t2) + 1;
+            F32 h10 = (t3 - (2 * t2) + t) * controller->duration;
+
+            A_PoseInertializationApply(output, &controller->offset, &controller->velocity, h00, h10, mask);
+        }
+        else {
+            if (controller->state == A_TRANSITION_STATE_CROSS_FADE) {
+                A_Playback *source = &controller->source;
+
+                A_PlaybackAdvance(source, skeleton, dt);
+                A_AnimationSamplePose(&controller->source_pose, skeleton, source->animation_index, source->time, source->loop_mode, source->cursor, mask);
+            }
+
+            F32 weight = t;
+            if (controller->curve == A_TRANSITION_CURVE_EASE) {
+                weight = t * t * (3 - (2 * t));
+            }
+
+            A_PoseLerp(output, &controller->source_pose, output, weight, mask);
+        }
+
+        if (t >= 1) {
+            controller->state = A_TRANSITION_STATE_NONE;
+        }
+    }
+
+    A_Pose swap = controller->previous;
+
+    controller->previous = controller->last;
+    controller->last     = swap;
+
+    A_PoseCopy(&controller->last, output);
+
+    controller->last_dt     = dt;
+    controller->num_outputs = Min(controller->num_outputs + 1, 2);
+}
+
+#include "math.cpp"
+
+#if !defined(ANIMATION_TOOL)
+    #include "vulkan.cpp"
+#endif
 
 #include "file_formats.c"
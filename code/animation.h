@@ -1,11 +1,22 @@
 #if !defined(ANIMATION_H_)
 #define ANIMATION_H_
 
-typedef struct A_Sample A_Sample;
-struct A_Sample {
-    Vec3F  position;
-    Quat4F orientation;
-    Vec3F  scale;
+// Bone transform relative to its parent. the hierarchy is solved by composing these directly, see Transform3F
+//
+typedef Transform3F A_Sample;
+
+// Structure-of-arrays pose, each component is stored in its own stream so the wide kernels can process
+// WIDE_LANES bones at a time. streams are padded up to a multiple of WIDE_MAX_LANES, the padding is initialised to
+// identity so it can be processed alongside the real bones without special casing
+//
+typedef struct A_Pose A_Pose;
+struct A_Pose {
+    U32 num_bones;
+    U32 capacity; // padded count of each stream
+
+    F32 *px, *py, *pz;
+    F32 *qw, *qx, *qy, *qz;
+    F32 *sx, *sy, *sz;
 };
 
 typedef struct A_Bone A_Bone;
@@ -14,21 +25,92 @@ struct A_Bone {
 
     U32 parent_index;
 
-    Mat4x4F  inv_bind_pose;
+    Mat3x4F  inv_bind_pose;
     A_Sample bind_pose;
 };
 
+typedef U32 A_ChannelFormat;
+enum {
+    A_CHANNEL_FORMAT_IDENTITY = 0, // no data, the identity transform component is used
+    A_CHANNEL_FORMAT_CONSTANT,     // one full precision value for the whole clip
+    A_CHANNEL_FORMAT_QUANTISED,    // three 16-bit values per frame, see the AMTS version 2 format
+    A_CHANNEL_FORMAT_SPARSE,       // three 16-bit values per key with the frame index of each key
+    A_CHANNEL_FORMAT_CURVE,        // cubic hermite curve per component, the knots are shared by the whole clip
+    A_CHANNEL_FORMAT_RAW           // full precision value per frame
+};
+
+typedef U32 A_ChannelType;
+enum {
+    A_CHANNEL_TYPE_POSITION = 0,
+    A_CHANNEL_TYPE_ORIENTATION,
+    A_CHANNEL_TYPE_SCALE,
+
+    A_CHANNEL_TYPE_COUNT
+};
+
+typedef struct A_Channel A_Channel;
+struct A_Channel {
+    A_ChannelFormat format;
+
+    // for constant channels this is the index of the first value in the constants array, for quantised and raw
+    // channels this is the byte offset from the start of the frame, for sparse channels it is the byte offset
+    // into the clip keys and for curve channels it is the index of the first component
+    //
+    U32 offset;
+};
+
+// Additive clips store the difference from a reference pose rather than a full pose, the reference is either the
+// first frame of the clip or the bind pose of the skeleton
+//
+typedef U32 A_AdditiveReference;
+enum {
+    A_ADDITIVE_REFERENCE_NONE = 0, // not an additive clip
+    A_ADDITIVE_REFERENCE_FIRST_FRAME,
+    A_ADDITIVE_REFERENCE_BIND_POSE
+};
+
+// Clip data loaded from the skeleton file, this is considered immutable after load and is shared between
+// all instances playing the clip. any per-instance playback state is stored in A_Playback
+//
+// Each bone has a channel for its position, orientation and scale, channels that change per frame are
+// packed together into a single block for each frame so sampling only touches two contiguous blocks
+//
 typedef struct A_Animation A_Animation;
 struct A_Animation {
     Str8 name;
 
     U32 num_frames;
-    F32 time;
-    F32 time_scale;
+    U32 frame_stride; // in bytes
+
+    // if this isn't A_ADDITIVE_REFERENCE_NONE every channel is a difference, see A_PoseAdditive
+    //
+    A_AdditiveReference additive;
+
+    U8  *frames;    // channel data for the first frame, indexed via (frame_stride * frame_index)
+    U8  *keys;      // sparse channel data
+    F32 *constants;
 
-    A_Sample *samples; // base sample for first frame, indexed via (num_bones * frame_index)
+    A_Channel *channels; // (num_bones * A_CHANNEL_TYPE_COUNT) count, indexed via (bone_index * A_CHANNEL_TYPE_COUNT)
+
+    // every curve component shares the same knots, each knot stores a value followed by a tangent (per frame)
+    // for every component. the components are padded to a multiple of WIDE_MAX_LANES
+    //
+    U32  num_knots;
+    U32  curve_stride; // padded component count
+    U16 *knot_frames;
+    F32 *curves;       // (2 * curve_stride) per knot
+
+    // for quantised positions and scales, value = min + (step * quantised)
+    //
+    Vec3F position_min;
+    Vec3F position_step;
+
+    Vec3F scale_min;
+    Vec3F scale_step;
 };
 
+typedef struct A_BoneLod A_BoneLod;
+
 typedef struct A_Skeleton A_Skeleton;
 struct A_Skeleton {
     U32 framerate;
@@ -40,16 +122,621 @@ struct A_Skeleton {
 
     A_Bone      *bones;
     A_Animation *animations;
+
+    U32        num_lods; // zero until A_SkeletonLodsBuild is called
+    A_BoneLod *lods;
+};
+
+typedef U32 A_LoopMode;
+enum {
+    A_LOOP_MODE_REPEAT = 0, // wraps back around to the first frame
+    A_LOOP_MODE_CLAMP       // holds on the final frame (or first frame when playing in reverse)
+};
+
+// Caches the last key used by each sparse channel so sampling forwards through a clip only has to step to the
+// next key instead of searching. this is reset when it is used with a different clip, sampling backwards, looping
+// or jumping more than a few keys ahead falls back to a binary search
+//
+typedef struct A_Cursor A_Cursor;
+struct A_Cursor {
+    A_Animation *animation; // clip the keys are valid for
+
+    U32 num_channels;
+
+    U16 *keys; // num_channels count, indexed via ((bone_index * A_CHANNEL_TYPE_COUNT) + channel_type)
+};
+
+// Per-instance playback state, this is small enough that many characters can play the same clip without
+// having to duplicate any of the skeleton or sample data
+//
+typedef struct A_Playback A_Playback;
+struct A_Playback {
+    U32 animation_index;
+
+    F32 time;       // in seconds from the start of the clip
+    F32 time_scale; // 1 is normal speed, can be negative to play in reverse
+
+    A_LoopMode loop_mode;
+
+    A_Cursor *cursor; // optional, owned by the instance
+};
+
+// One bit per bone, bit (bone_index % 64) of bits[bone_index / 64]. all of the functions taking a mask only sample,
+// blend or solve the bones which are set and leave the output for every other bone untouched, a null mask
+// includes every bone
+//
+typedef struct A_BoneMask A_BoneMask;
+struct A_BoneMask {
+    U32 num_bones;
+    U32 num_words;
+
+    U64 *bits;
+};
+
+Func A_BoneMask A_BoneMaskPush(Arena *arena, U32 num_bones); // no bones are set
+
+Func void A_BoneMaskSet(A_BoneMask *mask, U32 bone_index);
+Func void A_BoneMaskClear(A_BoneMask *mask, U32 bone_index);
+Func B32  A_BoneMaskTest(A_BoneMask *mask, U32 bone_index);
+
+// Sets the bone and all of its descendants
+//
+Func void A_BoneMaskSubtreeSet(A_BoneMask *mask, A_Skeleton *skeleton, U32 bone_index);
+
+// Bone LOD
+//
+// Each level lists the bones which are kept, lower detail levels drop bones that are deep in the hierarchy or
+// barely influence the mesh such as fingers, face and twist bones. culled bones are never sampled or solved,
+// their skinning matrix is the skinning matrix of their closest kept ancestor so vertices weighted to them move
+// rigidly with that ancestor and the vertex shader doesn't need to know about the level being used
+//
+// the ancestors of a kept bone are always kept, level 0 keeps every bone
+//
+typedef struct A_BoneLod A_BoneLod;
+struct A_BoneLod {
+    U32        num_kept;
+    A_BoneMask kept;
+
+    U32 *skin_bones; // closest kept ancestor of each culled bone, kept bones map to themselves
 };
 
-Func Mat4x4F A_SampleToM4x4F(A_Sample *sample);
+typedef struct A_Mesh A_Mesh;
+
+// Builds num_lods levels from the hierarchy depth of each bone and the total skin weight of each subtree across
+// the skinned submeshes of mesh. mesh can be null in which case every bone is treated as having equal influence
+//
+Func void A_SkeletonLodsBuild(Arena *arena, A_Skeleton *skeleton, A_Mesh *mesh, U32 num_lods);
+
+// Null for level 0 or if the skeleton has no levels, levels past the last are clamped to the last
+//
+Func A_BoneLod *A_SkeletonLodGet(A_Skeleton *skeleton, U32 lod);
+
+Func Mat3x4F A_SampleToM3x4F(A_Sample *sample);
 
 Func A_Sample A_SampleLerp(A_Sample *a, A_Sample *b, F32 t);
 
-Func A_Sample *A_AnimationSamplesForFrame(A_Animation *animation, U32 num_bones, U32 frame_index);
+// Sets up an uncompressed clip where every channel is raw, the samples are not copied and must remain valid for
+// the lifetime of the animation
+//
+Func void A_AnimationFromSamples(Arena *arena, A_Animation *animation, U32 num_bones, U32 num_frames, A_Sample *samples);
+
+// Converts a clip into differences from the reference, this is done once so applying the clip doesn't need to
+// invert the reference every frame. the differences are stored uncompressed, clips exported as additive are
+// already differences and don't need converting
+//
+Func void A_AnimationAdditiveMake(Arena *arena, A_Skeleton *skeleton, U32 animation_index, A_AdditiveReference reference);
+
+// Decompresses the sample for every bone at the frame specified, output_samples must have space for num_bones
+//
+// all of the sampling functions take an optional cursor, it can be null in which case any sparse channels are
+// searched every time
+//
+Func void A_AnimationFrameDecode(A_Sample *output_samples, A_Animation *animation, U32 num_bones, U32 frame_index, A_Cursor *cursor);
+
+Func A_Cursor *A_CursorPush(Arena *arena, A_Skeleton *skeleton);
+
+// Poses
+//
+Func A_Pose A_PosePush(Arena *arena, U32 num_bones);
+
+Func void A_PoseFromSamples(A_Pose *pose, A_Sample *samples);
+Func void A_PoseToSamples(A_Sample *samples, A_Pose *pose);
+
+Func A_Sample A_PoseSampleGet(A_Pose *pose, U32 bone_index);
+Func void     A_PoseSampleSet(A_Pose *pose, U32 bone_index, A_Sample *sample);
+
+// Wide equivalent of A_SampleLerp for every bone in the pose, all poses must have the same number of bones
+//
+Func void A_PoseLerp(A_Pose *output, A_Pose *a, A_Pose *b, F32 t, A_BoneMask *mask);
+
+// Same as A_PoseLerp but t is scaled by the weight of each bone, bone_weights must have pose->capacity values
+//
+Func void A_PoseLerpMasked(A_Pose *output, A_Pose *a, A_Pose *b, F32 *bone_weights, F32 t, A_BoneMask *mask);
+
+// Applies the difference between additive and reference to base, scaled by t. reference can be null in which case
+// additive is already a difference, i.e. position offset, orientation relative to identity and scale factor
+//
+Func void A_PoseAdditive(A_Pose *output, A_Pose *base, A_Pose *additive, A_Pose *reference, F32 t, A_BoneMask *mask);
+
+// Applies count additive differences to base in order, each scaled by its weight. base is only loaded and output
+// only stored once per block of bones no matter how many layers there are. layers with a weight of zero are not read
+//
+Func void A_PoseAdditiveStack(A_Pose *output, A_Pose *base, A_Pose **layers, F32 *weights, U32 count, A_BoneMask *mask);
+
+// Weighted blend of count poses, the weights should sum to one. inputs with a weight of zero are not read
+//
+Func void A_PoseBlend(A_Pose *output, A_Pose **inputs, F32 *weights, U32 count, A_BoneMask *mask);
+
+// Same as A_AnimationSample but outputs to a pose using the wide kernels
+//
+Func void A_AnimationSamplePose(A_Pose *output, A_Skeleton *skeleton, U32 animation_index, F32 time, A_LoopMode loop_mode, A_Cursor *cursor, A_BoneMask *mask);
+
+Func A_Playback A_PlaybackCreate(U32 animation_index, A_LoopMode loop_mode);
+
+// Moves the playback time forward by (time_scale * dt) and applies the loop mode
+//
+Func void A_PlaybackAdvance(A_Playback *playback, A_Skeleton *skeleton, F32 dt);
+
+// Samples the animation at the time provided. the skeleton and animation are not modified, if a cursor is provided
+// it is updated with the keys found so the next sample can start from them
+//
+// cursors are per-instance state owned by the caller, usually via A_Playback, and must not be shared between
+// instances sampling at the same time. the cursor can be null in which case every channel is searched
+//
+Func void A_AnimationSample(A_Sample *output_samples, A_Skeleton *skeleton, U32 animation_index, F32 time, A_LoopMode loop_mode, A_Cursor *cursor, A_BoneMask *mask);
+
+// Advances the playback and samples at the new time, output_samples must have space for skeleton->num_bones
+//
+// bones culled by the bone lod level are not sampled
+//
+Func void A_AnimationEvaluate(A_Sample *output_samples, A_Skeleton *skeleton, A_Playback *playback, F32 dt, A_BoneMask *mask, U32 lod);
+
+// Bones are solved if any bone in their subtree is set in the mask, so the local sample of each unset ancestor of a
+// set bone must still be valid
+//
+// bones culled by the bone lod level don't need a valid local sample, see A_BoneLod
+//
+Func void A_AnimationBoneMatricesGet(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Sample *samples, A_BoneMask *mask, U32 lod);
+
+// Same as A_AnimationBoneMatricesGet but the local transforms are read from the pose
+//
+Func void A_PoseBoneMatricesGet(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Pose *pose, A_BoneMask *mask, U32 lod);
+
+// Same as A_PoseBoneMatricesGet but the matrices are written with non-temporal stores and output_matrices is never
+// read, so it can point directly into mapped gpu memory that may be write-combined. output_matrices must be aligned
+// to 16 bytes
+//
+Func void A_PoseBoneMatricesStream(Mat3x4F *output_matrices, A_Skeleton *skeleton, A_Pose *pose, A_BoneMask *mask, U32 lod);
+
+// A_AnimationBoneMatricesGet split in two so the model space transforms can be modified in between, e.g. by IK or
+// constraints. the same bones are solved, bones culled by the bone lod level don't have a model transform but
+// A_BoneMatricesFromModel still writes their matrices from their closest kept ancestor
+//
+// :note unlike A_AnimationBoneMatricesGet the shear below non-uniformly scaled bones is dropped, see Transform3F
+//
+Func void A_AnimationModelTransformsGet(Transform3F *output_transforms, A_Skeleton *skeleton, A_Sample *samples, A_BoneMask *mask, U32 lod);
+Func void A_BoneMatricesFromModel(Mat3x4F *output_matrices, A_Skeleton *skeleton, Transform3F *model_transforms, A_BoneMask *mask, U32 lod);
+
+// Incremental palette
+//
+// Keeps the local samples, model space transforms and palette from the last solve of a single instance so only the
+// bones that changed since then are solved again. a bone is dirty if its local sample changed or it was set in the
+// dirty mask by the caller, dirty bones re-solve their whole subtree and everything else keeps its previous matrix.
+// useful when only a few bones move from frame to frame, e.g. a procedural look-at or finger poses on an idle
+//
+// when more than half of the bones are dirty, or the bone lod level changed, the full hierarchy is solved instead
+//
+typedef struct A_IncrementalPalette A_IncrementalPalette;
+struct A_IncrementalPalette {
+    A_Skeleton *skeleton;
+
+    B32 valid; // false until the first update, which is always a full solve
+    U32 lod;   // used by the last update
+
+    A_Sample    *local;
+
+    Transform3F *model;
+    Mat3x4F     *model_matrices; // model space matrices of sheared bones, see A_BoneHierarchySolve
+    A_BoneMask   sheared;
+
+    A_BoneMask dirty; // cleared after each update
+
+    Mat3x4F *palette;
+
+    U32 num_solved; // bones solved by the last update
+};
+
+Func A_IncrementalPalette A_IncrementalPaletteCreate(Arena *arena, A_Skeleton *skeleton);
+
+// Updates palette from the local samples provided, bones culled by the bone lod level don't need a valid sample
+//
+Func void A_IncrementalPaletteUpdate(A_IncrementalPalette *incremental, A_Sample *samples, U32 lod);
+
+// Transitions
+//
+// The controller plays a single clip and switches between clips over a period of time rather than instantly. while
+// cross fading both clips are sampled and blended, once the transition has finished only the new clip is sampled.
+// a transition that starts while another is still in progress fades from a snapshot of the last output instead
+// of keeping a third clip playing
+//
+// Inertialized transitions only ever sample the new clip, the difference between the last output and the new clip
+// is calculated when the transition starts and decays to zero over the duration, matching the velocity the
+// previous output was moving at
+//
+typedef U32 A_TransitionCurve;
+enum {
+    A_TRANSITION_CURVE_LINEAR = 0,
+    A_TRANSITION_CURVE_EASE       // smoothstep, not used by inertialized transitions which always use a cubic decay
+};
+
+typedef U32 A_TransitionFlags;
+enum {
+    A_TRANSITION_FLAG_INERTIALIZE = (1 << 0)
+};
+
+typedef U32 A_TransitionState;
+enum {
+    A_TRANSITION_STATE_NONE = 0,
+    A_TRANSITION_STATE_CROSS_FADE,  // from the source playback
+    A_TRANSITION_STATE_SNAPSHOT,    // from source_pose
+    A_TRANSITION_STATE_INERTIALIZE
+};
+
+typedef struct A_Controller A_Controller;
+struct A_Controller {
+    A_Skeleton *skeleton;
+
+    A_Playback target;
+    A_Playback source; // only valid while cross fading
+
+    A_TransitionState state;
+    A_TransitionCurve curve;
+
+    F32 duration;
+    F32 elapsed;
+
+    A_Pose source_pose;
+
+    // the last two outputs, inertialized transitions use these to find the velocity of the output when they start
+    //
+    U32    num_outputs; // up to two
+    F32    last_dt;
+    A_Pose last;
+    A_Pose previous;
+
+    // inertialization offset and velocity for each bone, positions and scales are stored as differences and
+    // orientations as the xyz components of a rotation vector scaled by tan(angle / 2), qw is unused
+    //
+    A_Pose offset;
+    A_Pose velocity;
+};
+
+Func A_Controller A_ControllerCreate(Arena *arena, A_Skeleton *skeleton, U32 animation_index, A_LoopMode loop_mode);
+
+// Starts a transition to the clip specified, playing from the start. a duration of zero switches immediately
+//
+Func void A_ControllerTransition(A_Controller *controller, U32 animation_index, A_LoopMode loop_mode, F32 duration, A_TransitionCurve curve, A_TransitionFlags flags);
+
+// Advances the controller by dt and writes the result to output, the same mask should be used for every call
+//
+Func void A_ControllerEvaluate(A_Pose *output, A_Controller *controller, F32 dt, A_BoneMask *mask);
+
+// Batched evaluation
+//
+// Each instance references its skeleton and has its own playback state, instances can freely mix skeletons
+// and clips. The output palette is contiguous, the matrices for an instance start directly after the matrices
+// for the instance before it in the input array, i.e. at the sum of skeleton->num_bones for all prior instances.
+//
+// Internally instances are grouped by (skeleton, clip, frame) so the sample data for each unique frame is only
+// walked once per call no matter how many instances are sampling it
+//
+typedef struct A_Instance A_Instance;
+struct A_Instance {
+    A_Skeleton *skeleton;
+    A_Playback  playback;
+
+    U32   lod;      // bone lod level, see A_SkeletonLodGet
+    Vec3F position; // only used by the update scheduler
+};
+
+// Total number of matrices required to store the palette for all of the instances
+//
+Func U64 A_InstancesPaletteCount(A_Instance *instances, U32 num_instances);
+
+// Advances the playback of all instances by dt and writes their final bone matrices to output_palette
+//
+// instances sharing a skeleton, animation and frame are evaluated together, these groups are distributed
+// across the job system if it has been initialised
+//
+Func void A_AnimationEvaluateBatch(Mat3x4F *output_palette, A_Instance *instances, U32 num_instances, F32 dt);
+
+// Pose cache
+//
+// Instances playing the same clip on the same pair of frames with the same interpolation amount produce the same
+// palette, so A_AnimationEvaluateCached only evaluates each unique (skeleton, clip, frame, t, bone lod) once and
+// every instance references the shared palette instead of having its own. the interpolation amount between the two
+// frames is quantised so instances that are close in time share a pose, larger quantisation gives exact results but
+// fewer hits
+//
+typedef struct A_PoseCache A_PoseCache;
+struct A_PoseCache {
+    U32 quantisation; // steps between each frame, zero to only share exactly matching times
+
+    U32      num_poses;     // unique poses evaluated by the last call
+    U64      palette_count; // used by the last call
+    U64      capacity;
+    Mat3x4F *palette;
+
+    // hit rate is (hits / lookups), a hit is an instance that referenced a pose evaluated for another instance
+    //
+    U32 frame_lookups;
+    U32 frame_hits;
+
+    U64 total_lookups;
+    U64 total_hits;
+};
+
+// The palette is sized for the worst case where every instance is unique, the instances passed to
+// A_AnimationEvaluateCached must not need more matrices than the instances provided here
+//
+Func A_PoseCache A_PoseCacheCreate(Arena *arena, A_Instance *instances, U32 num_instances, U32 quantisation);
+
+// Advances the playback of all instances by dt and evaluates each unique pose into cache->palette, the palette for
+// each instance starts at cache->palette[palette_offsets[index]] and remains valid until the next call
+//
+Func void A_AnimationEvaluateCached(U64 *palette_offsets, A_PoseCache *cache, A_Instance *instances, U32 num_instances, F32 dt);
+
+// Update scheduling
+//
+// Instances further away from the view are evaluated less often, every 1, 2, 4 or 8 frames depending on their
+// distance. Instances with the same rate are staggered so only a fraction of them update on any given frame and
+// the cost stays flat. On frames where an instance isn't evaluated its palette is blended from the palettes of
+// its last two updates, either extrapolated forward from the last update or interpolated one update behind
+//
+// The number of instances evaluated each frame is also limited by a cpu budget using a running estimate of the cost
+// to evaluate each instance, when more instances are due than the budget allows the most overdue are evaluated
+// first. instances that haven't been evaluated yet are always evaluated
+//
+typedef U32 A_UpdateBlend;
+enum {
+    A_UPDATE_BLEND_EXTRAPOLATE = 0,
+    A_UPDATE_BLEND_INTERPOLATE
+};
+
+#define A_UPDATE_MAX_RATE 8
+
+typedef struct A_UpdateState A_UpdateState;
+struct A_UpdateState {
+    U32 rate;         // frames between updates
+    U32 frames_since; // since the last update
+    U32 num_updates;  // capped at 2, the number of valid palettes
+
+    F32 dt;       // accumulated since the last update, the playback is advanced by this when it is next updated
+    F32 interval; // time between the last two updates
+};
+
+typedef struct A_UpdateScheduler A_UpdateScheduler;
+struct A_UpdateScheduler {
+    A_UpdateBlend blend;
+
+    F32 budget_us;     // zero for no limit
+    F32 near_distance; // closer instances update every frame, each slower rate starts at double the distance
+    F32 cost_us;       // estimated time to evaluate a single instance
+
+    U64 frame;
+
+    U32 num_instances;
+    U64 palette_count;
+
+    A_UpdateState *states;
+    U64           *offsets; // start of each instance in the palette
+
+    // palettes from the last two updates of each instance, the same layout as the batch output
+    //
+    Mat3x4F *last;
+    Mat3x4F *previous;
+
+    // stats for the most recent frame
+    //
+    U32 num_updated;
+    U32 num_deferred;   // due but over budget
+    U32 num_at_rate[4]; // indexed by log2(rate)
+    F32 update_us;
+};
+
+// The instances array must have the same instances in the same order for every call to A_UpdateSchedulerEvaluate
+//
+Func A_UpdateScheduler A_UpdateSchedulerCreate(Arena *arena, A_Instance *instances, U32 num_instances, F32 budget_us, F32 near_distance);
 
-Func void A_AnimationEvaluate(A_Sample *output_samples, A_Skeleton *skeleton, U32 animation_index, F32 dt);
-Func void A_AnimationBoneMatricesGet(Mat4x4F *output_matrices, A_Skeleton *skeleton, A_Sample *samples);
+// Evaluates the instances that are due this frame and blends the palette for the rest. view_p is the camera
+// position the instances are prioritised by, i.e. R_Setup.view_p. output_palette must be aligned to
+// (WIDE_MAX_LANES * sizeof(F32))
+//
+Func void A_UpdateSchedulerEvaluate(Mat3x4F *output_palette, A_UpdateScheduler *scheduler, A_Instance *instances, F32 dt, Vec3F view_p);
+
+// Baked clips
+//
+// Every frame of every clip in a skeleton can be evaluated up front into a single contiguous table of final skinning
+// matrices. Instances playing from the table are skinned straight from it by (clip, frame) so there is no sampling
+// or hierarchy work per frame, at the cost of snapping to the nearest frame and not supporting blending or bone lods
+//
+// Matrices are stored as Mat3x4F, optionally as half floats. The table has the same layout as the matrices in the
+// AMTB file format so it can be baked offline and loaded directly. Additive clips are baked as they are which makes
+// their matrices meaningless to skin from
+//
+typedef U32 A_BakeFlags;
+enum {
+    A_BAKE_FLAG_HALF = (1 << 0) // same as AMTB_FLAG_HALF
+};
+
+typedef struct A_BakedClip A_BakedClip;
+struct A_BakedClip {
+    U32 first_frame; // index of the first frame of the clip in the table
+    U32 num_frames;
+};
+
+typedef struct A_BakedClips A_BakedClips;
+struct A_BakedClips {
+    A_BakeFlags flags;
+
+    U32 framerate;
+    U32 num_bones;
+    U32 num_clips;    // same as skeleton->num_animations, indexed by animation index
+    U32 total_frames;
+
+    U32 matrix_size;  // in bytes, sizeof(Mat3x4F) or 24 with A_BAKE_FLAG_HALF
+    U64 frame_stride; // in bytes, (num_bones * matrix_size)
+
+    A_BakedClip *clips;
+
+    // the matrices for frame n of the table start at (data + (n * frame_stride)), aligned to 64 bytes
+    //
+    U64 size;
+    U8 *data;
+};
+
+Func A_BakedClips A_SkeletonBake(Arena *arena, A_Skeleton *skeleton, A_BakeFlags flags);
+
+// Index of the frame in the table for the frame of the clip specified, frame_index is clamped to the clip
+//
+Func U32 A_BakedFrameIndexGet(A_BakedClips *baked, U32 clip_index, U32 frame_index);
+
+// Copies the matrices for a frame in the table to a palette, converting from half floats if needed. output_matrices
+// must have space for num_bones matrices. full precision frames are already in the palette layout and can be used
+// directly from (data + (table_frame * frame_stride))
+//
+Func void A_BakedMatricesGet(Mat3x4F *output_matrices, A_BakedClips *baked, U32 table_frame);
+
+// Advances the playback of all instances by dt and writes the frame in the table each instance should be skinned
+// from to output_frames. every instance must use the skeleton the table was baked from
+//
+Func void A_AnimationEvaluateBaked(U32 *output_frames, A_BakedClips *baked, A_Instance *instances, U32 num_instances, F32 dt);
+
+// Blend trees
+//
+// A graph is built by adding nodes to an A_BlendGraph, each add returns the index of the new node which can then
+// be used as an input for later nodes. A_BlendTreeCreate flattens everything below the root node into a linear
+// list of ops which read from and write to pose registers, so evaluating the tree is a single loop over the ops.
+// nodes that are used as an input more than once are only evaluated once
+//
+// Node weights and blend space positions are read from parameters which can be changed between evaluations,
+// parameters are identified by an index chosen by the caller when adding the node
+//
+// Each op only samples and blends the bones that are needed by the ops reading its output, so the layer input of
+// a layer node is only evaluated for bones with a non-zero weight
+//
+typedef U32 A_BlendNodeType;
+enum {
+    A_BLEND_NODE_CLIP = 0,    // samples a clip, each clip node has its own playback
+    A_BLEND_NODE_LERP,        // lerp(inputs[0], inputs[1], param)
+    A_BLEND_NODE_ADDITIVE,    // inputs[0] with the difference between inputs[1] and inputs[2] applied, scaled by param
+    A_BLEND_NODE_BLEND_SPACE, // 1D blend space, the two inputs with positions either side of param are blended
+    A_BLEND_NODE_LAYER        // lerp(inputs[0], inputs[1], param * bone_weights[bone])
+};
+
+#define A_BLEND_NODE_NONE U32_MAX
+
+typedef struct A_BlendNode A_BlendNode;
+struct A_BlendNode {
+    A_BlendNodeType type;
+
+    U32 param;
+
+    U32  num_inputs;
+    U32 *inputs; // node indices, always less than the index of this node
+
+    U32        animation_index; // clip only
+    A_LoopMode loop_mode;
+
+    F32 *positions;    // blend space only, increasing, one per input
+    F32 *bone_weights; // layer only, one per bone
+};
+
+typedef struct A_BlendGraph A_BlendGraph;
+struct A_BlendGraph {
+    Arena      *arena;
+    A_Skeleton *skeleton;
+
+    U32 num_nodes;
+    U32 max_nodes;
+
+    A_BlendNode *nodes;
+};
+
+// Ops use the same types as the nodes they were created from, all register indices for the inputs of every op are
+// stored in a single array
+//
+typedef struct A_BlendOp A_BlendOp;
+struct A_BlendOp {
+    A_BlendNodeType type;
+
+    U32 output; // register, 0 is the output pose passed to A_BlendTreeEvaluate
+
+    U32 first_input;
+    U32 num_inputs;
+
+    U32 param;
+    U32 data; // index of the clip, offset into positions and weights for blend spaces, offset into bone_weights for layers
+};
+
+typedef struct A_BlendTree A_BlendTree;
+struct A_BlendTree {
+    A_Skeleton *skeleton;
+
+    U32 num_ops;
+    U32 num_registers;
+    U32 max_inputs; // of any single op
+
+    A_BlendOp *ops;
+    U32       *inputs;
+
+    U32         num_clips;
+    A_Playback *clips;
+    U32        *clip_nodes; // graph node each clip was created from
+
+    U32  num_params;
+    F32 *params;
+
+    F32 *positions;
+    F32 *weights;      // per-evaluation blend space weights, one per position
+    F32 *bone_weights; // padded to the pose capacity for each layer
+
+    U32  mask_words;
+    U64 *masks;        // bones needed from each op, mask_words per op
+};
+
+Func A_BlendGraph A_BlendGraphCreate(Arena *arena, A_Skeleton *skeleton, U32 max_nodes);
+
+Func U32 A_BlendClipAdd(A_BlendGraph *graph, U32 animation_index, A_LoopMode loop_mode);
+Func U32 A_BlendLerpAdd(A_BlendGraph *graph, U32 a, U32 b, U32 param);
+
+// reference can be A_BLEND_NODE_NONE if additive is already a difference, see A_PoseAdditive
+//
+Func U32 A_BlendAdditiveAdd(A_BlendGraph *graph, U32 base, U32 additive, U32 reference, U32 param);
+
+// inputs and positions have count values, positions must be increasing. the param is clamped to the range of
+// the positions
+//
+Func U32 A_BlendSpaceAdd(A_BlendGraph *graph, U32 *inputs, F32 *positions, U32 count, U32 param);
+
+// bone_weights has skeleton->num_bones values, bones with a weight of zero keep the base pose
+//
+Func U32 A_BlendLayerAdd(A_BlendGraph *graph, U32 base, U32 layer, F32 *bone_weights, U32 param);
+
+// The graph is no longer needed after the tree has been created, all parameters start at zero
+//
+Func A_BlendTree A_BlendTreeCreate(Arena *arena, A_BlendGraph *graph, U32 root);
+
+Func void A_BlendTreeParamSet(A_BlendTree *tree, U32 param, F32 value);
+
+// Playback state for a clip node, null if the node was not below the root of the tree
+//
+Func A_Playback *A_BlendTreePlaybackGet(A_BlendTree *tree, U32 node);
+
+// Advances every clip in the tree by dt and writes the blended result to output, intermediate poses are pushed
+// from a temp arena
+//
+Func void A_BlendTreeEvaluate(A_Pose *output, A_BlendTree *tree, F32 dt, A_BoneMask *mask);
 
 // Mesh file
 //
@@ -114,6 +801,42 @@ struct A_Mesh {
     A_Submesh  *submeshes;
     A_Material *materials;
     A_Texture  *textures;
+
+    // the vertex and index data for every submesh laid out exactly as the gpu buffers expect, each submesh starts at
+    // its base_vertex and base_index. skinned and static submeshes are in separate vertex blocks
+    //
+    U32 num_skinned_vertices;
+    U32 num_vertices;
+    U32 num_indices;
+
+    void *skinned_vertices; // R_SkinnedVertex3
+    void *vertices;         // R_Vertex3
+    void *indices;          // U16
 };
 
+// File loading
+//
+// The Load versions map the file and copy everything they need into the arena. the Map versions use the data in
+// place from the mapping, which must stay mapped for as long as the result is used
+//
+Func B32 SkeletonFileLoad(Arena *arena, A_Skeleton *skeleton, Str8 path);
+Func B32 SkeletonFileMap(Arena *arena, A_Skeleton *skeleton, OS_FileMapping *mapping, Str8 path);
+
+Func B32 MeshFileLoad(Arena *arena, A_Mesh *mesh, Str8 path);
+Func B32 MeshFileMap(Arena *arena, A_Mesh *mesh, OS_FileMapping *mapping, Str8 path);
+
+Func B32 BakedFileLoad(Arena *arena, A_BakedClips *baked, Str8 path);
+
+// Asynchronous loading, the whole file is read into the arena without blocking the calling thread. false is returned
+// if the file can't be opened or max_reads are already in flight on the queue, in which case nothing is left
+// allocated in the arena and the submit can be retried later
+//
+// once submitted the read must be finished with the function for the file type, which waits for the read if it is
+// still pending and closes the file. the data is used in place so must stay in the arena while the result is used
+//
+Func B32 FileReadSubmit(Arena *arena, OS_AsyncQueue *queue, OS_AsyncRead *read, Str8 path);
+
+Func B32 SkeletonFileReadFinish(Arena *arena, A_Skeleton *skeleton, OS_AsyncQueue *queue, OS_AsyncRead *read);
+Func B32 MeshFileReadFinish(Arena *arena, A_Mesh *mesh, OS_AsyncQueue *queue, OS_AsyncRead *read);
+
 #endif  // ANIMATION_H_
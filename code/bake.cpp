@@ -0,0 +1,221 @@
+// Bakes every clip in a skeleton file to a table of skinning matrices in the AMTB format, see A_BakedClips
+//
+// usage:
+//     bake [--half] <skeleton.amts> <output.amtb>
+//     bake --verify [--half] <skeleton.amts> [baked.amtb]
+//
+// --verify compares every matrix in the table against A_AnimationBoneMatricesGet for the decoded frame, this is
+// either the table baked from the skeleton or the table in the baked file if one is provided. returns non-zero if
+// any matrix is outside of the tolerance for the precision it was baked with
+//
+#define ANIMATION_TOOL 1
+#include "animation.cpp"
+
+#include <string.h>
+
+// Relative to the magnitude of the reference value for values above one, the half tolerance is a little over the
+// rounding error of a half float
+//
+#define BAKE_TOLERANCE      0.0001f
+#define BAKE_TOLERANCE_HALF 0.001f
+
+FileScope B32 BakedFileWrite(A_BakedClips *baked, Str8 path) {
+    B32 result = false;
+
+    TempArena temp = TempGet(0, 0);
+
+    U64 clips_size  = baked->num_clips * sizeof(AMTB_ClipInfo);
+    U32 data_offset = cast(U32) AlignUp(sizeof(AMTB_Header) + clips_size, 64);
+
+    U8 *prefix = ArenaPush(temp.arena, U8, data_offset);
+
+    AMTB_Header *header = cast(AMTB_Header *) prefix;
+
+    header->magic   = AMTB_MAGIC;
+    header->version = AMTB_VERSION;
+
+    header->flags     = (baked->flags & A_BAKE_FLAG_HALF) ? AMTB_FLAG_HALF : 0;
+    header->framerate = baked->framerate;
+
+    header->num_bones    = baked->num_bones;
+    header->num_clips    = baked->num_clips;
+    header->total_frames = baked->total_frames;
+
+    header->data_offset = data_offset;
+
+    AMTB_ClipInfo *clips = cast(AMTB_ClipInfo *) (header + 1);
+    for (U32 it = 0; it < baked->num_clips; ++it) {
+        clips[it].first_frame = baked->clips[it].first_frame;
+        clips[it].num_frames  = baked->clips[it].num_frames;
+    }
+
+    // the file is opened without truncating so make sure there isn't anything left over from a larger table
+    //
+    if (OS_FileExists(path)) { OS_FileDelete(path); }
+
+    OS_Handle file = OS_FileOpen(path, OS_FILE_ACCESS_WRITE);
+    if (file.v != cast(U64) -1) {
+        OS_FileWrite(file, prefix, 0, data_offset);
+        OS_FileWrite(file, baked->data, data_offset, baked->size);
+
+        OS_FileClose(file);
+
+        result = true;
+    }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+// The reference for each frame is decoded from the frame's own keys, sampling by time isn't used as the time of a
+// frame isn't exact in F32 and would pull in part of the next frame
+//
+FileScope B32 BakedVerify(A_BakedClips *baked, A_Skeleton *skeleton) {
+    B32 result = true;
+
+    if (baked->num_bones != skeleton->num_bones || baked->num_clips != skeleton->num_animations) {
+        printf("[error] :: baked table has %d bones and %d clips, skeleton has %d bones and %d animations\n",
+                baked->num_bones, baked->num_clips, skeleton->num_bones, skeleton->num_animations);
+
+        result = false;
+        return result;
+    }
+
+    TempArena temp = TempGet(0, 0);
+
+    A_Sample *samples  = ArenaPush(temp.arena, A_Sample, skeleton->num_bones);
+    Mat3x4F  *expected = ArenaPush(temp.arena, Mat3x4F,  skeleton->num_bones);
+    Mat3x4F  *actual   = ArenaPush(temp.arena, Mat3x4F,  skeleton->num_bones);
+
+    F32 tolerance = (baked->flags & A_BAKE_FLAG_HALF) ? BAKE_TOLERANCE_HALF : BAKE_TOLERANCE;
+
+    U64 num_failed = 0;
+
+    F32 max_error = 0;
+    U32 max_clip  = 0;
+    U32 max_frame = 0;
+    U32 max_bone  = 0;
+
+    for (U32 c = 0; c < skeleton->num_animations; ++c) {
+        A_Animation *animation = &skeleton->animations[c];
+
+        if (baked->clips[c].num_frames != animation->num_frames) {
+            printf("[error] :: clip %d has %d frames baked, expected %d\n", c, baked->clips[c].num_frames, animation->num_frames);
+
+            result = false;
+            continue;
+        }
+
+        for (U32 f = 0; f < animation->num_frames; ++f) {
+            A_AnimationFrameDecode(samples, animation, skeleton->num_bones, f, 0);
+            A_AnimationBoneMatricesGet(expected, skeleton, samples, 0, 0);
+
+            A_BakedMatricesGet(actual, baked, A_BakedFrameIndexGet(baked, c, f));
+
+            for (U32 b = 0; b < skeleton->num_bones; ++b) {
+                F32 error = 0;
+                for (U32 e = 0; e < 12; ++e) {
+                    F32 value = expected[b].e[e];
+                    F32 scale = Max(1.0f, (value < 0) ? -value : value);
+                    F32 diff  = actual[b].e[e] - value;
+
+                    error = Max(error, ((diff < 0) ? -diff : diff) / scale);
+                }
+
+                if (error > tolerance) { num_failed += 1; }
+
+                if (error > max_error) {
+                    max_error = error;
+                    max_clip  = c;
+                    max_frame = f;
+                    max_bone  = b;
+                }
+            }
+        }
+    }
+
+    printf("Verify:\n");
+    printf("    - %d frames, %d matrices\n", baked->total_frames, baked->total_frames * baked->num_bones);
+    printf("    - max error %g (clip %d, frame %d, bone %d), tolerance %g\n", max_error, max_clip, max_frame, max_bone, tolerance);
+    printf("    - %llu matrices outside tolerance\n", cast(unsigned long long) num_failed);
+
+    if (num_failed != 0) { result = false; }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+int main(int argc, char **argv) {
+    B32 verify = false;
+    B32 half   = false;
+
+    U32   num_paths = 0;
+    char *paths[2]  = { 0 };
+
+    for (int it = 1; it < argc; ++it) {
+        if (strcmp(argv[it], "--verify") == 0) {
+            verify = true;
+        }
+        else if (strcmp(argv[it], "--half") == 0) {
+            half = true;
+        }
+        else if (num_paths < ArraySize(paths)) {
+            paths[num_paths++] = argv[it];
+        }
+        else {
+            num_paths = 0;
+            break;
+        }
+    }
+
+    if (num_paths == 0 || (!verify && num_paths != 2)) {
+        printf("usage: bake [--half] <skeleton.amts> <output.amtb>\n");
+        printf("       bake --verify [--half] <skeleton.amts> [baked.amtb]\n");
+        return 1;
+    }
+
+    Arena *arena = ArenaAlloc(GB(64));
+
+    A_Skeleton skeleton = {};
+    if (!SkeletonFileLoad(arena, &skeleton, Str8WrapNullTerminated(cast(U8 *) paths[0]))) {
+        printf("[error] :: failed to load skeleton '%s'\n", paths[0]);
+        return 1;
+    }
+
+    A_BakedClips baked = {};
+
+    if (verify && num_paths == 2) {
+        if (!BakedFileLoad(arena, &baked, Str8WrapNullTerminated(cast(U8 *) paths[1]))) {
+            printf("[error] :: failed to load baked file '%s'\n", paths[1]);
+            return 1;
+        }
+    }
+    else {
+        U64 start = U64TicksGet();
+
+        baked = A_SkeletonBake(arena, &skeleton, half ? A_BAKE_FLAG_HALF : 0);
+
+        U64 end = U64TicksGet();
+
+        printf("Baked %d clips (%d frames, %d bones) in %.3fms, %llu bytes\n", baked.num_clips, baked.total_frames,
+                baked.num_bones, 1000.0 * F64ElapsedTimeGet(start, end), cast(unsigned long long) baked.size);
+    }
+
+    int result = 0;
+
+    if (verify) {
+        if (!BakedVerify(&baked, &skeleton)) { result = 1; }
+    }
+    else {
+        Str8 path = Str8WrapNullTerminated(cast(U8 *) paths[1]);
+
+        if (!BakedFileWrite(&baked, path)) {
+            printf("[error] :: failed to write baked file '%s'\n", paths[1]);
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -13,6 +13,9 @@ set cl_options=-nologo -Od -Zi -W4 -WX -wd4505 -wd4201 -I"libs\stb" -I"libs\SDL2
 set link_options=-libpath:"libs\SDL2\lib" SDL2d.lib
 
 cl %cl_options% "..\code\animation.cpp" -Fe"animation.exe" -link %link_options%
+cl %cl_options% "..\code\bake.cpp" -Fe"bake.exe"
+cl %cl_options% "..\code\cook.cpp" -Fe"cook.exe"
+cl %cl_options% "..\code\verify.cpp" -Fe"verify.exe"
 
 popd
 
@@ -24,11 +24,25 @@ glslang -V "../code/shaders/basic.frag" -o "shaders/basic.frag.spv"
 # compile application
 #
 COMPILER_OPTS="-O0 -g -ggdb -Wall -Werror -Wno-unused-function -Wno-unused-but-set-variable -Wno-unused-variable"
-LINKER_OPTS="-lSDL2"
+LINKER_OPTS="-lSDL2 -lpthread"
 
 echo "../code/animation.cpp"
 
 g++ $COMPILER_OPTS "../code/animation.cpp" -o "animation" $LINKER_OPTS
 
+# compile tools, these don't need sdl
+#
+echo "../code/bake.cpp"
+
+g++ $COMPILER_OPTS "../code/bake.cpp" -o "bake" -lpthread
+
+echo "../code/cook.cpp"
+
+g++ $COMPILER_OPTS "../code/cook.cpp" -o "cook" -lpthread
+
+echo "../code/verify.cpp"
+
+g++ $COMPILER_OPTS "../code/verify.cpp" -o "verify" -lpthread
+
 popd > /dev/null
 popd > /dev/null
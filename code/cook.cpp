@@ -0,0 +1,161 @@
+// Cooks an exported mesh file into the version 2 AMTM format, see file_formats.h
+//
+// usage:
+//     cook <input.amtm> <output.amtm>
+//
+// the vertices are quantised to the layout the renderer uses and the data for every submesh is packed into blocks
+// that are aligned and laid out exactly as the gpu buffers expect, so loading a cooked mesh is a single copy of each
+// block rather than converting every vertex on every launch
+//
+#define ANIMATION_TOOL 1
+#include "animation.cpp"
+
+FileScope B32 MeshFileCook(Str8 input, Str8 output) {
+    B32 result = false;
+
+    OS_FileMapping mapping = OS_FileMap(input);
+    if (mapping.data.count < cast(S64) sizeof(AMTM_Header)) {
+        printf("[error] :: failed to open '%.*s'\n", Str8Arg(input));
+
+        OS_FileUnmap(&mapping);
+        return result;
+    }
+
+    TempArena temp = TempGet(0, 0);
+
+    AMTM_Mesh amtm = { 0 };
+    AMTM_MeshFromData(temp.arena, &amtm, mapping.data);
+
+    if (amtm.version != 1) {
+        printf("[error] :: '%.*s' is not an uncooked mesh file (version %d)\n", Str8Arg(input), amtm.version);
+
+        TempRelease(&temp);
+        OS_FileUnmap(&mapping);
+
+        return result;
+    }
+
+    U32 num_skinned_vertices = 0;
+    U32 num_vertices         = 0;
+    U32 num_indices          = 0;
+
+    AMTM_CookedMeshInfo *infos = ArenaPush(temp.arena, AMTM_CookedMeshInfo, amtm.num_submeshes);
+
+    for (U32 it = 0; it < amtm.num_submeshes; ++it) {
+        AMTM_Submesh        *src = &amtm.submeshes[it];
+        AMTM_CookedMeshInfo *dst = &infos[it];
+
+        dst->info = *src->info;
+
+        // in submesh order, skinned and static submeshes are in separate vertex blocks as their sizes differ
+        //
+        if (src->info->flags & AMTM_MESH_FLAG_IS_SKINNED) {
+            dst->base_vertex      = num_skinned_vertices;
+            num_skinned_vertices += src->info->num_vertices;
+        }
+        else {
+            dst->base_vertex = num_vertices;
+            num_vertices    += src->info->num_vertices;
+        }
+
+        dst->base_index = num_indices;
+        num_indices    += src->info->num_indices;
+    }
+
+    // the string table, materials and texture info are the same as the input file
+    //
+    U64 prefix_size = cast(U64) ((cast(U8 *) (amtm.textures + amtm.num_textures)) - mapping.data.data) - sizeof(AMTM_Header);
+
+    U64 infos_offset   = sizeof(AMTM_Header) + prefix_size;
+    U64 skinned_offset = AlignUp(infos_offset + (amtm.num_submeshes * sizeof(AMTM_CookedMeshInfo)), AMTM_COOKED_ALIGNMENT);
+    U64 vertex_offset  = AlignUp(skinned_offset + (num_skinned_vertices * sizeof(AMTM_CookedSkinnedVertex)), AMTM_COOKED_ALIGNMENT);
+    U64 index_offset   = AlignUp(vertex_offset  + (num_vertices * sizeof(AMTM_CookedVertex)), AMTM_COOKED_ALIGNMENT);
+    U64 total_size     = AlignUp(index_offset   + (num_indices  * sizeof(U16)), AMTM_COOKED_ALIGNMENT);
+
+    if (total_size > U32_MAX) {
+        printf("[error] :: cooked mesh is too large (%llu bytes)\n", cast(unsigned long long) total_size);
+
+        TempRelease(&temp);
+        OS_FileUnmap(&mapping);
+
+        return result;
+    }
+
+    U8 *data = ArenaPush(temp.arena, U8, total_size, 0, AMTM_COOKED_ALIGNMENT);
+
+    AMTM_Header *header = cast(AMTM_Header *) data;
+
+    header->magic   = AMTM_MAGIC;
+    header->version = AMTM_VERSION;
+
+    header->num_meshes    = amtm.num_submeshes;
+    header->num_materials = amtm.num_materials;
+    header->num_textures  = amtm.num_textures;
+
+    header->string_table_count = cast(U32) amtm.string_table.count;
+
+    header->skinned_vertex_offset = cast(U32) skinned_offset;
+    header->num_skinned_vertices  = num_skinned_vertices;
+    header->vertex_offset         = cast(U32) vertex_offset;
+    header->num_vertices          = num_vertices;
+    header->index_offset          = cast(U32) index_offset;
+    header->num_indices           = num_indices;
+
+    MemoryCopy(header + 1, mapping.data.data + sizeof(AMTM_Header), prefix_size);
+    MemoryCopy(data + infos_offset, infos, amtm.num_submeshes * sizeof(AMTM_CookedMeshInfo));
+
+    R_SkinnedVertex3 *skinned_vertices = cast(R_SkinnedVertex3 *) (data + skinned_offset);
+    R_Vertex3        *vertices         = cast(R_Vertex3 *)        (data + vertex_offset);
+    U16              *indices          = cast(U16 *)              (data + index_offset);
+
+    for (U32 it = 0; it < amtm.num_submeshes; ++it) {
+        AMTM_Submesh        *src  = &amtm.submeshes[it];
+        AMTM_CookedMeshInfo *info = &infos[it];
+
+        if (src->info->flags & AMTM_MESH_FLAG_IS_SKINNED) {
+            SkinnedVerticesCook(&skinned_vertices[info->base_vertex], src->skinned_vertices, src->info->num_vertices);
+        }
+        else {
+            VerticesCook(&vertices[info->base_vertex], src->vertices, src->info->num_vertices);
+        }
+
+        MemoryCopy(&indices[info->base_index], src->indices, src->info->num_indices * sizeof(U16));
+    }
+
+    // the file is opened without truncating so make sure there isn't anything left over from a larger file
+    //
+    if (OS_FileExists(output)) { OS_FileDelete(output); }
+
+    OS_Handle file = OS_FileOpen(output, OS_FILE_ACCESS_WRITE);
+    if (file.v != cast(U64) -1) {
+        OS_FileWrite(file, data, 0, total_size);
+        OS_FileClose(file);
+
+        printf("Cooked %d submeshes (%d skinned vertices, %d vertices, %d indices), %lld -> %llu bytes\n",
+                amtm.num_submeshes, num_skinned_vertices, num_vertices, num_indices,
+                cast(long long) mapping.data.count, cast(unsigned long long) total_size);
+
+        result = true;
+    }
+    else {
+        printf("[error] :: failed to write '%.*s'\n", Str8Arg(output));
+    }
+
+    TempRelease(&temp);
+    OS_FileUnmap(&mapping);
+
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: cook <input.amtm> <output.amtm>\n");
+        return 1;
+    }
+
+    Str8 input  = Str8WrapNullTerminated(cast(U8 *) argv[1]);
+    Str8 output = Str8WrapNullTerminated(cast(U8 *) argv[2]);
+
+    int result = MeshFileCook(input, output) ? 0 : 1;
+    return result;
+}
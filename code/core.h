@@ -251,6 +251,13 @@ Func U32   U32AtomicExchange(volatile U32 *ptr, U32 exchange);
 Func U64   U64AtomicExchange(volatile U64 *ptr, U64 exchange);
 Func void *PtrAtomicExchange(void *volatile *ptr, void *exchange);
 
+// Sequentially consistent loads and stores
+//
+Func U32  U32AtomicLoad(volatile U32 *ptr);
+Func U64  U64AtomicLoad(volatile U64 *ptr);
+Func void U32AtomicStore(volatile U32 *ptr, U32 value);
+Func void U64AtomicStore(volatile U64 *ptr, U64 value);
+
 // Return true if operation succeeded, otherwise false
 //
 Func B32 U32AtomicCompareExchange(volatile U32 *ptr, U32 exchange, U32 comparand);
@@ -500,6 +507,49 @@ Func S64 Str8FindLast (Str8 str, U32 codepoint);
 Func Str8 Str8PathBasename(Str8 path);
 Func Str8 Str8PathDirname (Str8 path); // no trailing slash
 
+//
+// --------------------------------------------------------------------------------
+// :Job_System
+// --------------------------------------------------------------------------------
+//
+// Fixed pool of worker threads. every thread in the pool, including the thread that initialised the system,
+// owns a work-stealing deque. jobs are pushed to the deque of the thread pushing them and popped from the same
+// end by that thread, idle threads steal from the opposite end of the other deques
+//
+// Counters are used to wait on groups of jobs, they are incremented when a job is pushed and decremented
+// when the job has finished. waiting on a counter executes other jobs until the counter reaches zero, this
+// means jobs can push and wait on their own jobs without deadlocking the pool
+//
+// :note jobs must only be pushed from the thread that called JobSystemInit or from within other jobs. if the
+// job system has not been initialised jobs are executed immediately when they are pushed
+//
+
+#if !defined(JOB_QUEUE_CAPACITY)
+    #define JOB_QUEUE_CAPACITY 4096 // per thread, must be a power of two
+#endif
+
+#if !defined(JOB_MAX_WORKERS)
+    #define JOB_MAX_WORKERS 63
+#endif
+
+typedef void JobProc(void *data);
+
+typedef struct JobCounter JobCounter;
+struct JobCounter {
+    volatile U32 remaining;
+};
+
+// Passing zero for num_workers will create one worker per logical core, not including the calling thread
+//
+Func void JobSystemInit(Arena *arena, U32 num_workers);
+Func void JobSystemShutdown(void);
+
+Func U32 JobWorkerCount(void);
+Func U32 JobThreadIndex(void); // 0 on the thread that called JobSystemInit, [1, JobWorkerCount()] on workers
+
+Func void JobPush(JobProc *proc, void *data, JobCounter *counter); // counter can be null
+Func void JobCounterWait(JobCounter *counter);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -679,6 +729,27 @@ void *PtrAtomicExchange(void * volatile *ptr, void *exchange) {
     return result;
 }
 
+// :note msvc only gives volatile accesses acquire/release semantics on x64 by default so the interlocked
+// functions are used instead to make sure these are correct on arm64 as well
+//
+U32 U32AtomicLoad(volatile U32 *ptr) {
+    U32 result = _InterlockedCompareExchange((volatile long *) ptr, 0, 0);
+    return result;
+}
+
+U64 U64AtomicLoad(volatile U64 *ptr) {
+    U64 result = _InterlockedCompareExchange64((volatile __int64 *) ptr, 0, 0);
+    return result;
+}
+
+void U32AtomicStore(volatile U32 *ptr, U32 value) {
+    _InterlockedExchange((volatile long *) ptr, value);
+}
+
+void U64AtomicStore(volatile U64 *ptr, U64 value) {
+    _InterlockedExchange64((volatile __int64 *) ptr, value);
+}
+
 B32 U32AtomicCompareExchange(volatile U32 *ptr, U32 exchange, U32 comparand) {
     B32 result = _InterlockedCompareExchange((volatile long *) ptr, exchange, comparand) == (long) comparand;
     return result;
@@ -731,6 +802,24 @@ void *PtrAtomicExchange(void *volatile *ptr, void *exchange) {
     return result;
 }
 
+U32 U32AtomicLoad(volatile U32 *ptr) {
+    U32 result = __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+U64 U64AtomicLoad(volatile U64 *ptr) {
+    U64 result = __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+void U32AtomicStore(volatile U32 *ptr, U32 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+void U64AtomicStore(volatile U64 *ptr, U64 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
 B32 U32AtomicCompareExchange(volatile U32 *ptr, U32 exchange, U32 comparand) {
     B32 result = __atomic_compare_exchange(ptr, &comparand, &exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
     return result;
@@ -1587,4 +1676,477 @@ Str8 Str8PathDirname(Str8 path) {
 //
 #undef OS_PATH_SEPARATOR_CHECK
 
+//
+// --------------------------------------------------------------------------------
+// :Impl_OS_Threading
+// --------------------------------------------------------------------------------
+//
+// Minimal set of threading primitives required by the job system
+//
+
+typedef struct OS_Semaphore OS_Semaphore;
+
+FileScope U32  OS_CoreCount(void);
+FileScope B32  OS_ThreadStart(U32 index);  // runs JobWorkerThreadRun(index) on a new thread
+FileScope void OS_ThreadJoin(U32 index);
+FileScope void OS_ThreadYield(void);
+
+FileScope void OS_SemaphoreCreate(OS_Semaphore *semaphore);
+FileScope void OS_SemaphoreDestroy(OS_Semaphore *semaphore);
+FileScope void OS_SemaphoreWait(OS_Semaphore *semaphore);
+FileScope void OS_SemaphoreSignal(OS_Semaphore *semaphore, U32 count);
+
+FileScope void JobWorkerThreadRun(U32 index);
+
+#if OS_WINDOWS
+
+#if !defined(_WINDOWS_)
+    #define INFINITE             0xFFFFFFFF
+    #define ALL_PROCESSOR_GROUPS 0xFFFF
+
+    typedef void *HANDLE;
+    typedef long LONG;
+    typedef unsigned short WORD;
+
+    typedef DWORD (__stdcall *LPTHREAD_START_ROUTINE)(LPVOID);
+
+    #if defined(__cplusplus)
+        extern "C" __declspec(dllimport) HANDLE CreateThread(void *, SIZE_T, LPTHREAD_START_ROUTINE, LPVOID, DWORD, DWORD *);
+        extern "C" __declspec(dllimport) HANDLE CreateSemaphoreW(void *, LONG, LONG, const wchar_t *);
+        extern "C" __declspec(dllimport) BOOL   ReleaseSemaphore(HANDLE, LONG, LONG *);
+        extern "C" __declspec(dllimport) DWORD  WaitForSingleObject(HANDLE, DWORD);
+        extern "C" __declspec(dllimport) BOOL   CloseHandle(HANDLE);
+        extern "C" __declspec(dllimport) BOOL   SwitchToThread(void);
+        extern "C" __declspec(dllimport) DWORD  GetActiveProcessorCount(WORD);
+    #else
+        extern __declspec(dllimport) HANDLE CreateThread(void *, SIZE_T, LPTHREAD_START_ROUTINE, LPVOID, DWORD, DWORD *);
+        extern __declspec(dllimport) HANDLE CreateSemaphoreW(void *, LONG, LONG, const wchar_t *);
+        extern __declspec(dllimport) BOOL   ReleaseSemaphore(HANDLE, LONG, LONG *);
+        extern __declspec(dllimport) DWORD  WaitForSingleObject(HANDLE, DWORD);
+        extern __declspec(dllimport) BOOL   CloseHandle(HANDLE);
+        extern __declspec(dllimport) BOOL   SwitchToThread(void);
+        extern __declspec(dllimport) DWORD  GetActiveProcessorCount(WORD);
+    #endif
+#endif
+
+struct OS_Semaphore {
+    HANDLE handle;
+};
+
+GlobalVar HANDLE __os_threads[JOB_MAX_WORKERS + 1];
+
+FileScope DWORD __stdcall Win32_ThreadProc(LPVOID arg) {
+    JobWorkerThreadRun(cast(U32) cast(U64) arg);
+    return 0;
+}
+
+U32 OS_CoreCount(void) {
+    U32 result = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return result;
+}
+
+B32 OS_ThreadStart(U32 index) {
+    __os_threads[index] = CreateThread(0, 0, Win32_ThreadProc, cast(LPVOID) cast(U64) index, 0, 0);
+
+    B32 result = (__os_threads[index] != 0);
+    return result;
+}
+
+void OS_ThreadJoin(U32 index) {
+    WaitForSingleObject(__os_threads[index], INFINITE);
+    CloseHandle(__os_threads[index]);
+}
+
+void OS_ThreadYield(void) {
+    SwitchToThread();
+}
+
+void OS_SemaphoreCreate(OS_Semaphore *semaphore) {
+    semaphore->handle = CreateSemaphoreW(0, 0, S32_MAX, 0);
+}
+
+void OS_SemaphoreDestroy(OS_Semaphore *semaphore) {
+    CloseHandle(semaphore->handle);
+}
+
+void OS_SemaphoreWait(OS_Semaphore *semaphore) {
+    WaitForSingleObject(semaphore->handle, INFINITE);
+}
+
+void OS_SemaphoreSignal(OS_Semaphore *semaphore, U32 count) {
+    ReleaseSemaphore(semaphore->handle, cast(LONG) count, 0);
+}
+
+#elif (OS_MACOS || OS_LINUX)
+
+// :note macos doesn't support unnamed posix semaphores so a mutex and condition variable are used instead
+//
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+struct OS_Semaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    U32 count;
+};
+
+GlobalVar pthread_t __os_threads[JOB_MAX_WORKERS + 1];
+
+FileScope void *Posix_ThreadProc(void *arg) {
+    JobWorkerThreadRun(cast(U32) cast(U64) arg);
+    return 0;
+}
+
+U32 OS_CoreCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    U32 result = (count > 0) ? cast(U32) count : 1;
+    return result;
+}
+
+B32 OS_ThreadStart(U32 index) {
+    B32 result = pthread_create(&__os_threads[index], 0, Posix_ThreadProc, cast(void *) cast(U64) index) == 0;
+    return result;
+}
+
+void OS_ThreadJoin(U32 index) {
+    pthread_join(__os_threads[index], 0);
+}
+
+void OS_ThreadYield(void) {
+    sched_yield();
+}
+
+void OS_SemaphoreCreate(OS_Semaphore *semaphore) {
+    pthread_mutex_init(&semaphore->mutex, 0);
+    pthread_cond_init(&semaphore->cond, 0);
+
+    semaphore->count = 0;
+}
+
+void OS_SemaphoreDestroy(OS_Semaphore *semaphore) {
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->mutex);
+}
+
+void OS_SemaphoreWait(OS_Semaphore *semaphore) {
+    pthread_mutex_lock(&semaphore->mutex);
+
+    while (semaphore->count == 0) {
+        pthread_cond_wait(&semaphore->cond, &semaphore->mutex);
+    }
+
+    semaphore->count -= 1;
+
+    pthread_mutex_unlock(&semaphore->mutex);
+}
+
+void OS_SemaphoreSignal(OS_Semaphore *semaphore, U32 count) {
+    pthread_mutex_lock(&semaphore->mutex);
+
+    semaphore->count += count;
+
+    if (count == 1) { pthread_cond_signal(&semaphore->cond);    }
+    else            { pthread_cond_broadcast(&semaphore->cond); }
+
+    pthread_mutex_unlock(&semaphore->mutex);
+}
+
+#elif OS_SWITCH
+
+// @todo: libnx has threads but we don't use them yet, JobSystemInit will not start any workers and all jobs
+// are executed on the main thread while waiting
+//
+struct OS_Semaphore {
+    U32 unused;
+};
+
+U32 OS_CoreCount(void) {
+    U32 result = 1;
+    return result;
+}
+
+B32 OS_ThreadStart(U32 index) {
+    (void) index;
+
+    B32 result = false;
+    return result;
+}
+
+void OS_ThreadJoin(U32 index) { (void) index; }
+void OS_ThreadYield(void) { }
+
+void OS_SemaphoreCreate(OS_Semaphore *semaphore)  { (void) semaphore; }
+void OS_SemaphoreDestroy(OS_Semaphore *semaphore) { (void) semaphore; }
+void OS_SemaphoreWait(OS_Semaphore *semaphore)    { (void) semaphore; }
+
+void OS_SemaphoreSignal(OS_Semaphore *semaphore, U32 count) {
+    (void) semaphore;
+    (void) count;
+}
+
+#endif
+
+//
+// --------------------------------------------------------------------------------
+// :Impl_Job_System
+// --------------------------------------------------------------------------------
+//
+
+typedef struct Job Job;
+struct Job {
+    JobProc    *proc;
+    void       *data;
+    JobCounter *counter;
+};
+
+// Chase-Lev style work-stealing deque with a fixed capacity. the owning thread pushes and pops at the bottom,
+// other threads steal from the top. top and bottom only ever increase and are masked to index the ring
+//
+// top and bottom are kept on separate cache lines because they are written by different threads
+//
+typedef struct JobQueue JobQueue;
+struct JobQueue {
+    volatile U64 top;
+    U8 __pad0[56];
+
+    volatile U64 bottom;
+    U8 __pad1[56];
+
+    Job jobs[JOB_QUEUE_CAPACITY];
+};
+
+StaticAssert((JOB_QUEUE_CAPACITY & (JOB_QUEUE_CAPACITY - 1)) == 0);
+
+typedef struct JobSystem JobSystem;
+struct JobSystem {
+    U32 num_workers;
+    U32 num_queues; // num_workers + 1, zero when not initialised
+
+    volatile U32 shutdown;
+
+    JobQueue *queues;
+
+    // signalled once for each job pushed, idle workers wait on this
+    //
+    OS_Semaphore semaphore;
+};
+
+GlobalVar JobSystem __job_system;
+FileScope ThreadVar U32 __tls_job_index;
+
+FileScope B32 JobQueuePush(JobQueue *queue, Job *job) {
+    B32 result = false;
+
+    U64 bottom = queue->bottom;
+    U64 top    = U64AtomicLoad(&queue->top);
+
+    if ((bottom - top) < JOB_QUEUE_CAPACITY) {
+        queue->jobs[bottom & (JOB_QUEUE_CAPACITY - 1)] = *job;
+
+        // the job must be written before it is made visible to the stealing threads
+        //
+        U64AtomicStore(&queue->bottom, bottom + 1);
+
+        result = true;
+    }
+
+    return result;
+}
+
+FileScope B32 JobQueuePop(JobQueue *queue, Job *job) {
+    B32 result = false;
+
+    // the new bottom has to be visible to the stealing threads before we read top, otherwise both sides can
+    // take the final job
+    //
+    U64 bottom = queue->bottom - 1;
+    U64AtomicStore(&queue->bottom, bottom);
+
+    U64 top = U64AtomicLoad(&queue->top);
+
+    if (cast(S64) (bottom - top) >= 0) {
+        *job   = queue->jobs[bottom & (JOB_QUEUE_CAPACITY - 1)];
+        result = true;
+
+        if (bottom == top) {
+            // this is the last job, race any stealing threads for it
+            //
+            result = U64AtomicCompareExchange(&queue->top, top + 1, top);
+            U64AtomicStore(&queue->bottom, top + 1);
+        }
+    }
+    else {
+        // was already empty
+        //
+        U64AtomicStore(&queue->bottom, top);
+    }
+
+    return result;
+}
+
+FileScope B32 JobQueueSteal(JobQueue *queue, Job *job) {
+    B32 result = false;
+
+    U64 top    = U64AtomicLoad(&queue->top);
+    U64 bottom = U64AtomicLoad(&queue->bottom);
+
+    if (cast(S64) (bottom - top) > 0) {
+        // :note the owner may overwrite this slot while we are reading it if the job is taken by another thread,
+        // in that case top will have moved and the exchange fails so the torn job is never used
+        //
+        *job   = queue->jobs[top & (JOB_QUEUE_CAPACITY - 1)];
+        result = U64AtomicCompareExchange(&queue->top, top + 1, top);
+    }
+
+    return result;
+}
+
+FileScope void JobExecute(Job *job) {
+    job->proc(job->data);
+
+    if (job->counter) {
+        U32AtomicAdd(&job->counter->remaining, cast(U32) -1);
+    }
+}
+
+// Pops from the queue owned by the calling thread first, then tries to steal from all of the other queues
+//
+FileScope B32 JobFind(Job *job) {
+    B32 result = false;
+
+    JobSystem *jobs = &__job_system;
+    U32 index = __tls_job_index;
+
+    result = JobQueuePop(&jobs->queues[index], job);
+
+    for (U32 it = 1; !result && it < jobs->num_queues; ++it) {
+        U32 victim = (index + it) % jobs->num_queues;
+        result = JobQueueSteal(&jobs->queues[victim], job);
+    }
+
+    return result;
+}
+
+void JobWorkerThreadRun(U32 index) {
+    JobSystem *jobs = &__job_system;
+
+    __tls_job_index = index;
+
+    while (!U32AtomicLoad(&jobs->shutdown)) {
+        Job job;
+        if (JobFind(&job)) {
+            JobExecute(&job);
+        }
+        else {
+            OS_SemaphoreWait(&jobs->semaphore);
+        }
+    }
+}
+
+void JobSystemInit(Arena *arena, U32 num_workers) {
+    JobSystem *jobs = &__job_system;
+
+    Assert(jobs->num_queues == 0);
+
+    if (num_workers == 0) {
+        U32 cores   = OS_CoreCount();
+        num_workers = (cores > 1) ? (cores - 1) : 0;
+    }
+
+    num_workers = Min(num_workers, JOB_MAX_WORKERS);
+
+    jobs->shutdown = 0;
+    jobs->queues   = ArenaPush(arena, JobQueue, num_workers + 1, 0, 64);
+
+    OS_SemaphoreCreate(&jobs->semaphore);
+
+    __tls_job_index = 0;
+
+    // the queues have to be visible before any worker is started and are not changed afterwards, if a worker fails
+    // to start its queue is just left empty
+    //
+    jobs->num_workers = 0;
+    jobs->num_queues  = num_workers + 1;
+
+    for (U32 it = 1; it <= num_workers; ++it) {
+        if (!OS_ThreadStart(it)) { break; }
+        jobs->num_workers += 1;
+    }
+}
+
+void JobSystemShutdown(void) {
+    JobSystem *jobs = &__job_system;
+
+    if (jobs->num_queues != 0) {
+        U32AtomicStore(&jobs->shutdown, 1);
+        OS_SemaphoreSignal(&jobs->semaphore, jobs->num_workers);
+
+        for (U32 it = 1; it <= jobs->num_workers; ++it) {
+            OS_ThreadJoin(it);
+        }
+
+        OS_SemaphoreDestroy(&jobs->semaphore);
+
+        jobs->num_workers = 0;
+        jobs->num_queues  = 0;
+    }
+}
+
+U32 JobWorkerCount(void) {
+    U32 result = __job_system.num_workers;
+    return result;
+}
+
+U32 JobThreadIndex(void) {
+    U32 result = __tls_job_index;
+    return result;
+}
+
+void JobPush(JobProc *proc, void *data, JobCounter *counter) {
+    JobSystem *jobs = &__job_system;
+
+    Job job;
+    job.proc    = proc;
+    job.data    = data;
+    job.counter = counter;
+
+    if (counter) {
+        U32AtomicAdd(&counter->remaining, 1);
+    }
+
+    B32 queued = false;
+
+    if (jobs->num_queues != 0) {
+        queued = JobQueuePush(&jobs->queues[__tls_job_index], &job);
+        if (queued) {
+            OS_SemaphoreSignal(&jobs->semaphore, 1);
+        }
+    }
+
+    if (!queued) {
+        // either the job system isn't running or the queue is full, either way just run it now
+        //
+        JobExecute(&job);
+    }
+}
+
+void JobCounterWait(JobCounter *counter) {
+    JobSystem *jobs = &__job_system;
+
+    while (U32AtomicLoad(&counter->remaining) != 0) {
+        Job job;
+        if (jobs->num_queues != 0 && JobFind(&job)) {
+            JobExecute(&job);
+        }
+        else {
+            // the remaining jobs are running on other threads
+            //
+            OS_ThreadYield();
+        }
+    }
+}
+
 #endif  // CORE_IMPL
@@ -18,9 +18,17 @@ void AMTS_SkeletonFromData(AMTS_Skeleton *skeleton, Str8 data) {
         skeleton->num_tracks    = header->num_tracks;
         skeleton->total_samples = header->total_samples;
 
-        skeleton->bones   = cast(AMTS_BoneInfo  *) (skeleton->string_table.data + skeleton->string_table.count);
-        skeleton->tracks  = cast(AMTS_TrackInfo *) (skeleton->bones  + skeleton->num_bones);
-        skeleton->samples = cast(AMTS_Sample    *) (skeleton->tracks + skeleton->num_tracks);
+        skeleton->bones  = cast(AMTS_BoneInfo  *) (skeleton->string_table.data + skeleton->string_table.count);
+        skeleton->tracks = cast(AMTS_TrackInfo *) (skeleton->bones  + skeleton->num_bones);
+
+        if (header->version >= 2) {
+            skeleton->clips          = cast(AMTS_ClipInfo *) (skeleton->tracks + skeleton->num_tracks);
+            skeleton->clip_data_size = header->clip_data_size;
+            skeleton->clip_data      = cast(U8 *) (skeleton->clips + skeleton->num_tracks);
+        }
+        else {
+            skeleton->samples = cast(AMTS_Sample *) (skeleton->tracks + skeleton->num_tracks);
+        }
     }
 }
 
@@ -39,16 +47,28 @@ void AMTS_SkeletonCopyFromData(Arena *arena, AMTS_Skeleton *skeleton, Str8 data)
         skeleton->num_tracks    = header->num_tracks;
         skeleton->total_samples = header->total_samples;
 
-        U8 *string_table        = cast(U8 *) (header + 1);
-        AMTS_BoneInfo  *bones   = cast(AMTS_BoneInfo  *) (string_table + skeleton->string_table.count);
-        AMTS_TrackInfo *tracks  = cast(AMTS_TrackInfo *) (bones  + skeleton->num_bones);
-        AMTS_Sample    *samples = cast(AMTS_Sample    *) (tracks + skeleton->num_tracks);
+        U8 *string_table       = cast(U8 *) (header + 1);
+        AMTS_BoneInfo  *bones  = cast(AMTS_BoneInfo  *) (string_table + skeleton->string_table.count);
+        AMTS_TrackInfo *tracks = cast(AMTS_TrackInfo *) (bones  + skeleton->num_bones);
 
         skeleton->string_table.data = ArenaPushCopy(arena, string_table, U8, skeleton->string_table.count);
 
-        skeleton->bones   = ArenaPushCopy(arena, bones,   AMTS_BoneInfo,  skeleton->num_bones);
-        skeleton->tracks  = ArenaPushCopy(arena, tracks,  AMTS_TrackInfo, skeleton->num_tracks);
-        skeleton->samples = ArenaPushCopy(arena, samples, AMTS_Sample,    skeleton->total_samples);
+        skeleton->bones  = ArenaPushCopy(arena, bones,  AMTS_BoneInfo,  skeleton->num_bones);
+        skeleton->tracks = ArenaPushCopy(arena, tracks, AMTS_TrackInfo, skeleton->num_tracks);
+
+        if (header->version >= 2) {
+            AMTS_ClipInfo *clips     = cast(AMTS_ClipInfo *) (tracks + skeleton->num_tracks);
+            U8            *clip_data = cast(U8 *) (clips + skeleton->num_tracks);
+
+            skeleton->clip_data_size = header->clip_data_size;
+
+            skeleton->clips     = ArenaPushCopy(arena, clips,     AMTS_ClipInfo, skeleton->num_tracks);
+            skeleton->clip_data = ArenaPushCopy(arena, clip_data, U8,            skeleton->clip_data_size, 0, 16);
+        }
+        else {
+            AMTS_Sample *samples = cast(AMTS_Sample *) (tracks + skeleton->num_tracks);
+            skeleton->samples    = ArenaPushCopy(arena, samples, AMTS_Sample, skeleton->total_samples);
+        }
     }
 }
 
@@ -104,19 +124,51 @@ void AMTM_MeshFromData(Arena *arena, AMTM_Mesh *mesh, Str8 data) {
         mesh->materials = cast(AMTM_Material *) (string_table.data + string_table.count);
         mesh->textures  = cast(AMTM_Texture  *) (mesh->materials + mesh->num_materials);
 
-        AMTM_MeshInfo *info = cast(AMTM_MeshInfo *) (mesh->textures + mesh->num_textures);
+        if (header->version >= 2) {
+            // cooked, the vertex and index data is in blocks after the mesh info
+            //
+            mesh->num_skinned_vertices = header->num_skinned_vertices;
+            mesh->num_vertices         = header->num_vertices;
+            mesh->num_indices          = header->num_indices;
+
+            mesh->skinned_vertex_data = cast(AMTM_CookedSkinnedVertex *) (data.data + header->skinned_vertex_offset);
+            mesh->vertex_data         = cast(AMTM_CookedVertex *)        (data.data + header->vertex_offset);
+            mesh->index_data          = cast(U16 *)                      (data.data + header->index_offset);
 
-        for (U32 it = 0; it < mesh->num_submeshes; ++it) {
-            AMTM_Submesh *submesh = &mesh->submeshes[it];
+            AMTM_CookedMeshInfo *cooked = cast(AMTM_CookedMeshInfo *) (mesh->textures + mesh->num_textures);
 
-            B32 is_skinned  = (info->flags & AMTM_MESH_FLAG_IS_SKINNED) != 0;
-            U64 vertex_size = is_skinned ? sizeof(AMTM_SkinnedVertex) : sizeof(AMTM_Vertex);
+            for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+                AMTM_Submesh *submesh = &mesh->submeshes[it];
 
-            submesh->info     = info;
-            submesh->vertices = cast(AMTM_Vertex *) (info + 1);
-            submesh->indices  = cast(U16 *) ((U8 *) submesh->vertices + (info->num_vertices * vertex_size));
+                submesh->info        = &cooked[it].info;
+                submesh->base_vertex = cooked[it].base_vertex;
+                submesh->base_index  = cooked[it].base_index;
 
-            info = cast(AMTM_MeshInfo *) (submesh->indices + info->num_indices);
+                if (submesh->info->flags & AMTM_MESH_FLAG_IS_SKINNED) {
+                    submesh->cooked_skinned_vertices = mesh->skinned_vertex_data + submesh->base_vertex;
+                }
+                else {
+                    submesh->cooked_vertices = mesh->vertex_data + submesh->base_vertex;
+                }
+
+                submesh->indices = mesh->index_data + submesh->base_index;
+            }
+        }
+        else {
+            AMTM_MeshInfo *info = cast(AMTM_MeshInfo *) (mesh->textures + mesh->num_textures);
+
+            for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+                AMTM_Submesh *submesh = &mesh->submeshes[it];
+
+                B32 is_skinned  = (info->flags & AMTM_MESH_FLAG_IS_SKINNED) != 0;
+                U64 vertex_size = is_skinned ? sizeof(AMTM_SkinnedVertex) : sizeof(AMTM_Vertex);
+
+                submesh->info     = info;
+                submesh->vertices = cast(AMTM_Vertex *) (info + 1);
+                submesh->indices  = cast(U16 *) ((U8 *) submesh->vertices + (info->num_vertices * vertex_size));
+
+                info = cast(AMTM_MeshInfo *) (submesh->indices + info->num_indices);
+            }
         }
     }
 }
@@ -145,32 +197,66 @@ void AMTM_MeshCopyFromData(Arena *arena, AMTM_Mesh *mesh, Str8 data) {
         mesh->materials = ArenaPushCopy(arena, materials, AMTM_Material, mesh->num_materials);
         mesh->textures  = ArenaPushCopy(arena, textures,  AMTM_Texture,  mesh->num_textures);
 
-        AMTM_MeshInfo *info = cast(AMTM_MeshInfo *) (textures + mesh->num_textures);
+        if (header->version >= 2) {
+            mesh->num_skinned_vertices = header->num_skinned_vertices;
+            mesh->num_vertices         = header->num_vertices;
+            mesh->num_indices          = header->num_indices;
 
-        for (U32 it = 0; it < mesh->num_submeshes; ++it) {
-            AMTM_Submesh *submesh = &mesh->submeshes[it];
+            AMTM_CookedSkinnedVertex *skinned_vertices = cast(AMTM_CookedSkinnedVertex *) (data.data + header->skinned_vertex_offset);
+            AMTM_CookedVertex        *vertices         = cast(AMTM_CookedVertex *)        (data.data + header->vertex_offset);
+            U16                      *indices          = cast(U16 *)                      (data.data + header->index_offset);
 
-            submesh->info = ArenaPushCopy(arena, info, AMTM_MeshInfo);
+            mesh->skinned_vertex_data = ArenaPushCopy(arena, skinned_vertices, AMTM_CookedSkinnedVertex, mesh->num_skinned_vertices, 0, AMTM_COOKED_ALIGNMENT);
+            mesh->vertex_data         = ArenaPushCopy(arena, vertices,         AMTM_CookedVertex,        mesh->num_vertices,         0, AMTM_COOKED_ALIGNMENT);
+            mesh->index_data          = ArenaPushCopy(arena, indices,          U16,                      mesh->num_indices,          0, AMTM_COOKED_ALIGNMENT);
 
-            U16 *indices;
-            B32 is_skinned = (info->flags & AMTM_MESH_FLAG_IS_SKINNED) != 0;
+            AMTM_CookedMeshInfo *cooked = cast(AMTM_CookedMeshInfo *) (textures + mesh->num_textures);
 
-            if (is_skinned) {
-                AMTM_SkinnedVertex *vertices = cast(AMTM_SkinnedVertex *) (info + 1);
-                submesh->skinned_vertices = ArenaPushCopy(arena, vertices, AMTM_SkinnedVertex, info->num_vertices);
+            for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+                AMTM_Submesh *submesh = &mesh->submeshes[it];
 
-                indices = cast(U16 *) (vertices + info->num_vertices);
-            }
-            else {
-                AMTM_Vertex *vertices = cast(AMTM_Vertex *) (info + 1);
-                submesh->vertices = ArenaPushCopy(arena, vertices, AMTM_Vertex, info->num_vertices);
+                submesh->info        = ArenaPushCopy(arena, &cooked[it].info, AMTM_MeshInfo);
+                submesh->base_vertex = cooked[it].base_vertex;
+                submesh->base_index  = cooked[it].base_index;
+
+                if (submesh->info->flags & AMTM_MESH_FLAG_IS_SKINNED) {
+                    submesh->cooked_skinned_vertices = mesh->skinned_vertex_data + submesh->base_vertex;
+                }
+                else {
+                    submesh->cooked_vertices = mesh->vertex_data + submesh->base_vertex;
+                }
 
-                indices = cast(U16 *) (vertices + info->num_vertices);
+                submesh->indices = mesh->index_data + submesh->base_index;
             }
+        }
+        else {
+            AMTM_MeshInfo *info = cast(AMTM_MeshInfo *) (textures + mesh->num_textures);
+
+            for (U32 it = 0; it < mesh->num_submeshes; ++it) {
+                AMTM_Submesh *submesh = &mesh->submeshes[it];
+
+                submesh->info = ArenaPushCopy(arena, info, AMTM_MeshInfo);
+
+                U16 *indices;
+                B32 is_skinned = (info->flags & AMTM_MESH_FLAG_IS_SKINNED) != 0;
+
+                if (is_skinned) {
+                    AMTM_SkinnedVertex *vertices = cast(AMTM_SkinnedVertex *) (info + 1);
+                    submesh->skinned_vertices = ArenaPushCopy(arena, vertices, AMTM_SkinnedVertex, info->num_vertices);
+
+                    indices = cast(U16 *) (vertices + info->num_vertices);
+                }
+                else {
+                    AMTM_Vertex *vertices = cast(AMTM_Vertex *) (info + 1);
+                    submesh->vertices = ArenaPushCopy(arena, vertices, AMTM_Vertex, info->num_vertices);
 
-            submesh->indices = ArenaPushCopy(arena, indices, U16, info->num_indices);
+                    indices = cast(U16 *) (vertices + info->num_vertices);
+                }
 
-            info = cast(AMTM_MeshInfo *) (indices + info->num_indices);
+                submesh->indices = ArenaPushCopy(arena, indices, U16, info->num_indices);
+
+                info = cast(AMTM_MeshInfo *) (indices + info->num_indices);
+            }
         }
     }
 }
@@ -202,3 +288,71 @@ void AMTM_MeshFromPath(Arena *arena, AMTM_Mesh *mesh, Str8 path) {
 
 #endif
 
+U32 AMTB_MatrixSizeGet(U32 flags) {
+    U32 result = (flags & AMTB_FLAG_HALF) ? (12 * sizeof(U16)) : (12 * sizeof(F32));
+    return result;
+}
+
+void AMTB_BakedFromData(AMTB_Baked *baked, Str8 data) {
+    AMTB_Header *header = cast(AMTB_Header *) data.data;
+
+    if (data.count >= cast(S64) sizeof(AMTB_Header) && header->magic == AMTB_MAGIC && header->version <= AMTB_VERSION) {
+        U64 data_size = cast(U64) header->total_frames * header->num_bones * AMTB_MatrixSizeGet(header->flags);
+
+        // unlike the other formats the matrix data is the bulk of the file and is used directly, so make sure it
+        // is all there
+        //
+        // the clip info has to fit before the matrix data and every clip has to be inside the table
+        //
+        U64 clips_end = sizeof(AMTB_Header) + (cast(U64) header->num_clips * sizeof(AMTB_ClipInfo));
+        B32 valid     = (clips_end <= header->data_offset) && (header->data_offset + data_size <= cast(U64) data.count);
+
+        AMTB_ClipInfo *clips = cast(AMTB_ClipInfo *) (header + 1);
+
+        for (U32 it = 0; valid && it < header->num_clips; ++it) {
+            valid = (cast(U64) clips[it].first_frame + clips[it].num_frames) <= header->total_frames;
+        }
+
+        if (valid) {
+            baked->header    = header;
+            baked->version   = header->version;
+            baked->flags     = header->flags;
+            baked->framerate = header->framerate;
+
+            baked->num_bones    = header->num_bones;
+            baked->num_clips    = header->num_clips;
+            baked->total_frames = header->total_frames;
+
+            baked->clips = clips;
+
+            baked->data_size = data_size;
+            baked->data      = data.data + header->data_offset;
+        }
+    }
+}
+
+#if defined(OS_H_)
+
+void AMTB_BakedFromPath(Arena *arena, AMTB_Baked *baked, Str8 path) {
+    OS_Handle file = OS_FileOpen(path, OS_FILE_ACCESS_READ);
+
+    TempArena temp = TempGet(1, &arena);
+
+    OS_FileInfo info = OS_FileInfoFromHandle(temp.arena, file);
+
+    // the matrices are 64 byte aligned in the file so keep that alignment in memory
+    //
+    Str8 data;
+    data.count = info.size;
+    data.data  = ArenaPush(arena, U8, data.count, ARENA_FLAG_NO_ZERO, 64);
+
+    OS_FileRead(file, data.data, 0, data.count);
+
+    AMTB_BakedFromData(baked, data);
+
+    TempRelease(&temp);
+
+    OS_FileClose(file);
+}
+
+#endif
@@ -7,21 +7,25 @@
 // [ String Table ] // header.string_table_count in length
 // [ Bone Info    ] // header.num_bones count
 // [ Track Info   ] // header.num_tracks count
-// [ Samples      ] // header.total_samples count
+// [ Samples      ] // header.total_samples count, version 1 only
+// [ Clip Info    ] // header.num_tracks count, version 2 and above
+// [ Clip Data    ] // header.clip_data_size bytes, version 2 and above
 //
 // Header {
 //     U32 magic;   // == AMTS
-//     U32 version; // == 1
+//     U32 version; // <= 4
 //
 //     U32 num_bones;
 //     U32 num_tracks;
 //
-//     U32 total_samples;
+//     U32 total_samples; // for version 2 this is the number of samples before compression
 //
 //     U32 framerate;
 //     U32 string_table_count;
 //
-//     U32 pad[9]; // to 64 bytes
+//     U32 clip_data_size; // version 2 and above
+//
+//     U32 pad[8]; // to 64 bytes
 // }
 //
 // StringTable {
@@ -51,8 +55,90 @@
 //     F32 scale[3];
 // }
 //
+// ClipInfo {
+//     F32 position_min[3];
+//     F32 position_extent[3]; // max - min
+//
+//     F32 scale_min[3];
+//     F32 scale_extent[3];
+//
+//     U32 data_offset; // from beginning of the clip data, 4 byte aligned
+//     U32 data_size;
+// }
+//
+// ClipData {
+//     U16 channel_formats[AlignUp(header.num_bones, 2)]; // [4 bit scale][4 bit orientation][4 bit position]
+//     F32 constants[];                                   // each constant channel in bone order
+//     U16 frames[track.num_frames][];                    // each quantised channel in bone order
+//     SparseChannel sparse[];                            // each sparse channel in bone order, version 3 and above
+//     CurveData curves;                                  // only present if any channel is a curve, version 4 only
+// }
+//
+// :note versions 2 and 3 store the channel formats as 'U8 channel_formats[AlignUp(header.num_bones, 4)]' with
+// 2 bits per channel in the same order
+//
+// SparseChannel {
+//     U16 num_keys;
+//     U16 pad;
+//
+//     U16 key_frames[num_keys];   // increasing, the first key is always frame 0 and the last is (num_frames - 1)
+//     U16 values[num_keys][3];    // quantised the same as QUANTISED channels
+// }
+//
+// CurveData { // 4 byte aligned
+//     U32 num_knots;
+//     U16 knot_frames[AlignUp(num_knots, 2)]; // increasing, the first knot is always frame 0 and the last is (num_frames - 1)
+//
+//     F32 values[num_knots][2][num_components]; // value then tangent (per frame) for each curve component in bone order
+// }
+//
+// Each bone has a channel for its position, orientation and scale which is stored in one of the following
+// formats:
+//
+//     IDENTITY  -- no data, position is (0, 0, 0), orientation is (1, 0, 0, 0) and scale is (1, 1, 1)
+//     CONSTANT  -- a single full precision value for the whole clip, 3 floats or 4 floats for orientation
+//     QUANTISED -- three 16-bit values per frame
+//     SPARSE    -- three 16-bit values per key, only the keys needed to reconstruct the channel within a
+//                  tolerance using linear interpolation are stored (version 3)
+//     CURVE     -- cubic hermite curve for each component, 3 components or 4 for orientation. the knots are shared
+//                  by every curve channel in the clip (version 4)
+//
+// Clips exported with curves have the CURVES flag set on their track info, all of their animated channels are
+// curves. Orientation curves are fitted on the raw quaternion components and must be normalised after evaluation
+//
+// Clips exported with the ADDITIVE flag store differences from a reference pose for every channel, the position
+// offset, the orientation relative to the reference (conjugate(reference) * orientation) and the scale factor. the
+// reference is the first frame of the clip, or the parent relative bind pose if ADDITIVE_BIND_POSE is also set
+//
+// Quantised positions and scales are stored as 'min + extent * (value / 65535)' using the bounds from the
+// clip info. Quantised orientations use the smallest three encoding, the largest component is dropped and the
+// remaining three (in wxyz order) are stored in the low 15 bits as 'value / 32767' mapped to [-1/sqrt(2), 1/sqrt(2)].
+// The index of the dropped component is stored in the top bit of the first two values, low bit first, and is
+// reconstructed as positive
+//
 #define AMTS_MAGIC   FourCC('A', 'M', 'T', 'S')
-#define AMTS_VERSION 1
+#define AMTS_VERSION 4
+
+typedef U32 AMTS_ChannelFormat;
+enum {
+    AMTS_CHANNEL_FORMAT_IDENTITY = 0,
+    AMTS_CHANNEL_FORMAT_CONSTANT,
+    AMTS_CHANNEL_FORMAT_QUANTISED,
+    AMTS_CHANNEL_FORMAT_SPARSE,
+    AMTS_CHANNEL_FORMAT_CURVE
+};
+
+// number of bits per channel, channels are stored in position, orientation, scale order from the low bits up
+//
+#define AMTS_CHANNEL_FORMAT_BITS    4
+#define AMTS_CHANNEL_FORMAT_BITS_V2 2 // versions 2 and 3
+
+typedef U32 AMTS_TrackFlags;
+enum {
+    AMTS_TRACK_FLAG_CURVES             = (1 << 0),
+    AMTS_TRACK_FLAG_ADDITIVE           = (1 << 1), // the clip stores differences from its first frame
+    AMTS_TRACK_FLAG_ADDITIVE_BIND_POSE = (1 << 2)  // with ADDITIVE, the differences are from the bind pose instead
+};
 
 #pragma pack(push, 1)
 
@@ -69,7 +155,9 @@ struct AMTS_Header {
     U32 framerate;
     U32 string_table_count;
 
-    U32 pad[9];
+    U32 clip_data_size;
+
+    U32 pad[8];
 };
 
 StaticAssert(sizeof(AMTS_Header) == 64);
@@ -113,6 +201,26 @@ struct AMTS_TrackInfo {
     U32 num_frames;
 };
 
+// Version 2 and above, the compressed channel data for each track is located at (clip_data + clip.data_offset)
+//
+typedef struct AMTS_ClipInfo AMTS_ClipInfo;
+struct AMTS_ClipInfo {
+    F32 position_min[3];
+    F32 position_extent[3];
+
+    F32 scale_min[3];
+    F32 scale_extent[3];
+
+    U32 data_offset;
+    U32 data_size;
+};
+
+// the exporter relies on these sizes to align the clip data
+//
+StaticAssert(sizeof(AMTS_BoneInfo)  == 84);
+StaticAssert(sizeof(AMTS_TrackInfo) == 8);
+StaticAssert(sizeof(AMTS_ClipInfo)  == 56);
+
 #pragma pack(pop)
 
 typedef struct AMTS_Skeleton AMTS_Skeleton;
@@ -131,7 +239,12 @@ struct AMTS_Skeleton {
     AMTS_TrackInfo *tracks;
 
     U32 total_samples;
-    AMTS_Sample *samples; // flat array of header.total_samples
+    AMTS_Sample *samples; // flat array of header.total_samples, version 1 only
+
+    AMTS_ClipInfo *clips; // header.num_tracks count, version 2 and above
+
+    U32 clip_data_size;
+    U8 *clip_data;
 };
 
 Func void AMTS_SkeletonFromData(AMTS_Skeleton *skeleton, Str8 data);
@@ -152,9 +265,22 @@ Func void AMTS_SkeletonCopyFromData(Arena *arena, AMTS_Skeleton *skeleton, Str8
 //   - [ Vertex Data ] // per mesh
 //   - [ Index Data  ] // per mesh
 //
+// Version 2 files are cooked from version 1 files by the cook tool, the vertices are already quantised to the
+// layout the renderer uses and the data for all meshes is stored in three blocks that can be copied directly into
+// the gpu buffers. each block is aligned to 16 bytes from the start of the file
+//
+// [ Header              ]
+// [ String Table        ]
+// [ Materials           ]
+// [ Texture Info        ]
+// [ Cooked Mesh Info    ] // header.num_meshes count
+// [ Skinned Vertex Data ] // at header.skinned_vertex_offset, header.num_skinned_vertices count
+// [ Vertex Data         ] // at header.vertex_offset, header.num_vertices count
+// [ Index Data          ] // at header.index_offset, header.num_indices count
+//
 // Header {
 //     U32 magic;   // == AMTM
-//     U32 version; // == 1
+//     U32 version; // == 1 or 2
 //
 //     U32 num_meshes;
 //
@@ -163,7 +289,16 @@ Func void AMTS_SkeletonCopyFromData(Arena *arena, AMTS_Skeleton *skeleton, Str8
 //
 //     U32 string_table_count;
 //
-//     U32 pad[10]; // to 64 bytes
+//     // version 2 and above, zero otherwise
+//     //
+//     U32 skinned_vertex_offset;
+//     U32 num_skinned_vertices;
+//     U32 vertex_offset;
+//     U32 num_vertices;
+//     U32 index_offset;
+//     U32 num_indices;
+//
+//     U32 pad[4]; // to 64 bytes
 // }
 //
 // String Table {
@@ -228,6 +363,28 @@ Func void AMTS_SkeletonCopyFromData(Arena *arena, AMTS_Skeleton *skeleton, Str8
 //     U16 value;
 // }
 //
+// CookedMeshInfo {
+//     MeshInfo info;
+//
+//     U32 base_vertex; // into the skinned vertex block if the mesh is skinned, otherwise the vertex block
+//     U32 base_index;  // into the index block, the indices are relative to base_vertex
+// }
+//
+// CookedVertex {
+//     F32 position[3];
+//     U16 uv[2];       // unorm
+//     U8  normal[4];   // ((n * 127) + 127.5), w is unused
+//
+//     U32 material_index;
+// }
+//
+// CookedSkinnedVertex {
+//     CookedVertex vertex;
+//
+//     U8 bone_indices[4];
+//     U8 bone_weights[4]; // unorm
+// }
+//
 // Properties ordering:
 //     METALLIC
 //     ROUGHNESS
@@ -252,7 +409,9 @@ Func void AMTS_SkeletonCopyFromData(Arena *arena, AMTS_Skeleton *skeleton, Str8
 //
 
 #define AMTM_MAGIC   FourCC('A', 'M', 'T', 'M')
-#define AMTM_VERSION 1
+#define AMTM_VERSION 2
+
+#define AMTM_COOKED_ALIGNMENT 16
 
 #define AMTM_TEXTURE_CHANNELS_SHIFT 24
 #define AMTM_TEXTURE_INDEX_MASK     0xFFFFFF
@@ -299,7 +458,14 @@ struct AMTM_Header {
 
     U32 string_table_count;
 
-    U32 pad[10];
+    U32 skinned_vertex_offset;
+    U32 num_skinned_vertices;
+    U32 vertex_offset;
+    U32 num_vertices;
+    U32 index_offset;
+    U32 num_indices;
+
+    U32 pad[4];
 };
 
 StaticAssert(sizeof(AMTM_Header) == 64);
@@ -356,15 +522,51 @@ struct AMTM_SkinnedVertex {
     F32 bone_weights[4];
 };
 
+typedef struct AMTM_CookedMeshInfo AMTM_CookedMeshInfo;
+struct AMTM_CookedMeshInfo {
+    AMTM_MeshInfo info;
+
+    U32 base_vertex;
+    U32 base_index;
+};
+
+typedef struct AMTM_CookedVertex AMTM_CookedVertex;
+struct AMTM_CookedVertex {
+    F32 position[3];
+    U16 uv[2];
+    U8  normal[4];
+
+    U32 material_index;
+};
+
+typedef struct AMTM_CookedSkinnedVertex AMTM_CookedSkinnedVertex;
+struct AMTM_CookedSkinnedVertex {
+    AMTM_CookedVertex vertex;
+
+    U8 bone_indices[4];
+    U8 bone_weights[4];
+};
+
+StaticAssert(sizeof(AMTM_CookedVertex)        == 24);
+StaticAssert(sizeof(AMTM_CookedSkinnedVertex) == 32);
+
 #pragma pack(pop)
 
 typedef struct AMTM_Submesh AMTM_Submesh;
 struct AMTM_Submesh {
     AMTM_MeshInfo *info;
 
+    // version 2 and above, into the cooked blocks on the mesh
+    //
+    U32 base_vertex;
+    U32 base_index;
+
     union {
         AMTM_Vertex        *vertices;
         AMTM_SkinnedVertex *skinned_vertices;
+
+        AMTM_CookedVertex        *cooked_vertices;
+        AMTM_CookedSkinnedVertex *cooked_skinned_vertices;
     };
 
     U16 *indices;
@@ -385,6 +587,16 @@ struct AMTM_Mesh {
     AMTM_Material *materials;
     AMTM_Texture  *textures;
     AMTM_Submesh  *submeshes; // Allocated from arena
+
+    // version 2 and above, the cooked vertex and index blocks
+    //
+    U32 num_skinned_vertices;
+    U32 num_vertices;
+    U32 num_indices;
+
+    AMTM_CookedSkinnedVertex *skinned_vertex_data;
+    AMTM_CookedVertex        *vertex_data;
+    U16                      *index_data;
 };
 
 Func void AMTM_MeshFromData(Arena *arena, AMTM_Mesh *mesh, Str8 data);
@@ -395,4 +607,105 @@ Func void AMTM_MeshCopyFromData(Arena *arena, AMTM_Mesh *mesh, Str8 data);
     Func void AMTM_MeshFromFile(Arena *arena, AMTM_Mesh *mesh, OS_Handle file);
 #endif
 
+// Baked (AMTB) file format
+//
+// [ Header    ]
+// [ Clip Info ] // header.num_clips count
+// [ Matrices  ] // header.total_frames * header.num_bones matrices, starting at header.data_offset
+//
+// Header {
+//     U32 magic;   // == AMTB
+//     U32 version; // == 1
+//
+//     U32 flags;
+//     U32 framerate;
+//
+//     U32 num_bones;
+//     U32 num_clips;    // same as the number of tracks in the skeleton file it was baked from, in the same order
+//     U32 total_frames; // sum of num_frames for all clips
+//
+//     U32 data_offset; // from the beginning of the file, 64 byte aligned
+//
+//     U32 pad[8]; // to 64 bytes
+// }
+//
+// ClipInfo {
+//     U32 first_frame; // index of the first frame of the clip in the matrices
+//     U32 num_frames;
+// }
+//
+// Matrices {
+//     Matrix frames[header.total_frames][header.num_bones];
+// }
+//
+// Each matrix is the final skinning matrix for a bone (model space transform * inverse bind pose) at a frame of a
+// clip, so the matrix for (clip, frame, bone) is at frames[clip.first_frame + frame][bone]. only the top three
+// rows are stored in row major order as the bottom row is always (0, 0, 0, 1). matrices are 12 F32 or 12 IEEE half
+// floats if the HALF flag is set
+//
+#define AMTB_MAGIC   FourCC('A', 'M', 'T', 'B')
+#define AMTB_VERSION 1
+
+typedef U32 AMTB_Flags;
+enum {
+    AMTB_FLAG_HALF = (1 << 0)
+};
+
+#pragma pack(push, 1)
+
+typedef struct AMTB_Header AMTB_Header;
+struct AMTB_Header {
+    U32 magic;
+    U32 version;
+
+    U32 flags;
+    U32 framerate;
+
+    U32 num_bones;
+    U32 num_clips;
+    U32 total_frames;
+
+    U32 data_offset;
+
+    U32 pad[8];
+};
+
+StaticAssert(sizeof(AMTB_Header) == 64);
+
+typedef struct AMTB_ClipInfo AMTB_ClipInfo;
+struct AMTB_ClipInfo {
+    U32 first_frame;
+    U32 num_frames;
+};
+
+#pragma pack(pop)
+
+typedef struct AMTB_Baked AMTB_Baked;
+struct AMTB_Baked {
+    AMTB_Header *header;
+
+    U32 version;
+    U32 flags;
+    U32 framerate;
+
+    U32 num_bones;
+    U32 num_clips;
+    U32 total_frames;
+
+    AMTB_ClipInfo *clips;
+
+    U64 data_size; // in bytes
+    U8 *data;
+};
+
+// The size of a single matrix in bytes for the flags provided
+//
+Func U32 AMTB_MatrixSizeGet(U32 flags);
+
+Func void AMTB_BakedFromData(AMTB_Baked *baked, Str8 data);
+
+#if defined(OS_H_)
+    Func void AMTB_BakedFromPath(Arena *arena, AMTB_Baked *baked, Str8 path);
+#endif
+
 #endif  // FILE_FORMATS_H_
@@ -42,6 +42,25 @@ Mat4x4F M4x4FIdentity() {
     return result;
 }
 
+Mat3x4F M3x4FIdentity() {
+    Mat3x4F result = {
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0
+    };
+
+    return result;
+}
+
+Transform3F T3FIdentity() {
+    Transform3F result;
+    result.position    = V3F(0, 0, 0);
+    result.orientation = Q4FIdentity();
+    result.scale       = V3F(1, 1, 1);
+
+    return result;
+}
+
 Mat4x4F M4x4FRotationX(F32 turns) {
     F32 s = sinf(turns * (F32) M_PI * 2);
     F32 c = cosf(turns * (F32) M_PI * 2);
@@ -203,6 +222,133 @@ Mat4x4F Q4FToM4x4F(Quat4F q) {
     return result;
 }
 
+Mat3x4F Q4FToM3x4F(Quat4F q) {
+    Mat3x4F result;
+
+    F32 xx = (q.x * q.x);
+    F32 yy = (q.y * q.y);
+    F32 zz = (q.z * q.z);
+
+    F32 xy = (q.x * q.y);
+    F32 xz = (q.x * q.z);
+    F32 xw = (q.x * q.w);
+
+    F32 yz = (q.y * q.z);
+    F32 yw = (q.y * q.w);
+
+    F32 zw = (q.z * q.w);
+
+    // row 0
+    result.m[0][0] = 1 - 2 * yy - 2 * zz;
+    result.m[0][1] =     2 * xy - 2 * zw;
+    result.m[0][2] =     2 * xz + 2 * yw;
+    result.m[0][3] = 0;
+
+    // row 1
+    result.m[1][0] =     2 * xy + 2 * zw;
+    result.m[1][1] = 1 - 2 * xx - 2 * zz;
+    result.m[1][2] =     2 * yz - 2 * xw;
+    result.m[1][3] = 0;
+
+    // row 2
+    result.m[2][0] =     2 * xz - 2 * yw;
+    result.m[2][1] =     2 * yz + 2 * xw;
+    result.m[2][2] = 1 - 2 * xx - 2 * yy;
+    result.m[2][3] = 0;
+
+    return result;
+}
+
+Mat3x4F T3FToM3x4F(Transform3F t) {
+    Mat3x4F result = Q4FToM3x4F(t.orientation);
+
+    // (T * R * S) so the columns of the rotation are scaled
+    //
+    for (U32 r = 0; r < 3; ++r) {
+        result.m[r][0] *= t.scale.x;
+        result.m[r][1] *= t.scale.y;
+        result.m[r][2] *= t.scale.z;
+        result.m[r][3]  = t.position.e[r];
+    }
+
+    return result;
+}
+
+U16 F32ToF16(F32 x) {
+    U16 result;
+
+    U32 bits;
+    MemoryCopy(&bits, &x, sizeof(U32));
+
+    U32 sign     = (bits >> 16) & 0x8000;
+    U32 abs      = (bits & 0x7FFFFFFF);
+    U32 exponent = (abs >> 23);
+
+    if (abs >= 0x7F800000) {
+        // infinity or nan, nans are kept quiet
+        //
+        result = cast(U16) (sign | 0x7C00 | ((abs > 0x7F800000) ? 0x200 : 0));
+    }
+    else if (abs >= 0x477FF000) {
+        // rounds to 65520 or above which is out of range
+        //
+        result = cast(U16) (sign | 0x7C00);
+    }
+    else if (exponent < 113) {
+        // below the smallest normal half, the mantissa is shifted down to units of 2^-24 with the implicit bit
+        //
+        U32 mantissa = (abs & 0x7FFFFF) | 0x800000;
+        U32 shift    = 126 - exponent;
+        U32 value    = 0;
+
+        if (exponent != 0 && shift <= 24) {
+            U32 remainder = mantissa & ((1 << shift) - 1);
+            U32 halfway   = (1 << (shift - 1));
+
+            value = (mantissa >> shift);
+            if (remainder > halfway || (remainder == halfway && (value & 1))) { value += 1; }
+        }
+
+        result = cast(U16) (sign | value);
+    }
+    else {
+        // rebias the exponent from 127 to 15, carrying out of the mantissa when rounding correctly moves to the
+        // next exponent
+        //
+        U32 rebased = abs - (112 << 23);
+        result = cast(U16) (sign | ((rebased + 0xFFF + ((rebased >> 13) & 1)) >> 13));
+    }
+
+    return result;
+}
+
+F32 F16ToF32(U16 x) {
+    F32 result;
+
+    U32 sign     = cast(U32) (x & 0x8000) << 16;
+    U32 exponent = (x >> 10) & 0x1F;
+    U32 mantissa = (x & 0x3FF);
+
+    U32 bits;
+    if (exponent == 0) {
+        // zero or subnormal, both are exact as a float
+        //
+        F32 value = cast(F32) mantissa * (1.0f / 16777216.0f);
+        MemoryCopy(&bits, &value, sizeof(U32));
+
+        bits |= sign;
+    }
+    else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    MemoryCopy(&result, &bits, sizeof(U32));
+    return result;
+}
+
 // Operators
 //
 Vec3F V3FAdd(Vec3F a, Vec3F b) {
@@ -253,6 +399,50 @@ Quat4F Q4FNeg(Quat4F q) {
     return result;
 }
 
+Quat4F Q4FMul(Quat4F a, Quat4F b) {
+    Quat4F result;
+    result.w = (a.w * b.w) - (a.x * b.x) - (a.y * b.y) - (a.z * b.z);
+    result.x = (a.w * b.x) + (a.x * b.w) + (a.y * b.z) - (a.z * b.y);
+    result.y = (a.w * b.y) - (a.x * b.z) + (a.y * b.w) + (a.z * b.x);
+    result.z = (a.w * b.z) + (a.x * b.y) - (a.y * b.x) + (a.z * b.w);
+
+    return result;
+}
+
+Quat4F Q4FConjugate(Quat4F q) {
+    Quat4F result;
+    result.w =  q.w;
+    result.x = -q.x;
+    result.y = -q.y;
+    result.z = -q.z;
+
+    return result;
+}
+
+Vec3F Q4FMulV3F(Quat4F q, Vec3F v) {
+    // (q * v * conjugate(q)) expanded to v + (w * t) + (u x t) where t = 2 * (u x v)
+    //
+    Vec3F t = V3FScale(V3FCross(q.xyz, v), 2.0f);
+
+    Vec3F result = V3FAdd(V3FAdd(v, V3FScale(t, q.w)), V3FCross(q.xyz, t));
+    return result;
+}
+
+Transform3F T3FMul(Transform3F a, Transform3F b) {
+    Transform3F result;
+
+    result.position    = T3FMulV3F(a, b.position);
+    result.orientation = Q4FMul(a.orientation, b.orientation);
+    result.scale       = V3FHadamard(a.scale, b.scale);
+
+    return result;
+}
+
+Vec3F T3FMulV3F(Transform3F a, Vec3F b) {
+    Vec3F result = V3FAdd(a.position, Q4FMulV3F(a.orientation, V3FHadamard(a.scale, b)));
+    return result;
+}
+
 Vec3F V3FHadamard(Vec3F a, Vec3F b) {
     Vec3F result;
     result.x = (a.x * b.x);
@@ -291,11 +481,85 @@ Vec4F V4FScale(Vec4F a, F32 b) {
     return result;
 }
 
+#if ARCH_AMD64
+
+// :note each row of the result is a linear combination of the rows of b, the additions are done in the same order
+// as the scalar version below
+//
+FileScope __m128 M4x4FRowCombine(Mat4x4F *a, U32 r, __m128 b0, __m128 b1, __m128 b2, __m128 b3) {
+    __m128 result;
+    result = _mm_mul_ps(_mm_set1_ps(a->m[r][0]), b0);
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(a->m[r][1]), b1));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(a->m[r][2]), b2));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(a->m[r][3]), b3));
+
+    return result;
+}
+
 Mat4x4F M4x4FMul(Mat4x4F a, Mat4x4F b) {
     Mat4x4F result;
 
-    // @speed: simd
-    //
+    __m128 b0 = _mm_loadu_ps(b.m[0]);
+    __m128 b1 = _mm_loadu_ps(b.m[1]);
+    __m128 b2 = _mm_loadu_ps(b.m[2]);
+    __m128 b3 = _mm_loadu_ps(b.m[3]);
+
+    _mm_storeu_ps(result.m[0], M4x4FRowCombine(&a, 0, b0, b1, b2, b3));
+    _mm_storeu_ps(result.m[1], M4x4FRowCombine(&a, 1, b0, b1, b2, b3));
+    _mm_storeu_ps(result.m[2], M4x4FRowCombine(&a, 2, b0, b1, b2, b3));
+    _mm_storeu_ps(result.m[3], M4x4FRowCombine(&a, 3, b0, b1, b2, b3));
+
+    return result;
+}
+
+Mat3x4F M3x4FMul(Mat3x4F a, Mat3x4F b) {
+    Mat3x4F result;
+
+    __m128 b0 = _mm_loadu_ps(b.m[0]);
+    __m128 b1 = _mm_loadu_ps(b.m[1]);
+    __m128 b2 = _mm_loadu_ps(b.m[2]);
+    __m128 b3 = _mm_setr_ps(0, 0, 0, 1);
+
+    for (U32 r = 0; r < 3; ++r) {
+        __m128 row;
+        row = _mm_mul_ps(_mm_set1_ps(a.m[r][0]), b0);
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[r][1]), b1));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[r][2]), b2));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[r][3]), b3));
+
+        _mm_storeu_ps(result.m[r], row);
+    }
+
+    return result;
+}
+
+void M3x4FMulStream(Mat3x4F *output, Mat3x4F a, Mat3x4F b) {
+    Assert((cast(U64) output & 15) == 0);
+
+    __m128 b0 = _mm_loadu_ps(b.m[0]);
+    __m128 b1 = _mm_loadu_ps(b.m[1]);
+    __m128 b2 = _mm_loadu_ps(b.m[2]);
+    __m128 b3 = _mm_setr_ps(0, 0, 0, 1);
+
+    for (U32 r = 0; r < 3; ++r) {
+        __m128 row;
+        row = _mm_mul_ps(_mm_set1_ps(a.m[r][0]), b0);
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[r][1]), b1));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[r][2]), b2));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[r][3]), b3));
+
+        _mm_stream_ps(output->m[r], row);
+    }
+}
+
+void StoreFence() {
+    _mm_sfence();
+}
+
+#else
+
+Mat4x4F M4x4FMul(Mat4x4F a, Mat4x4F b) {
+    Mat4x4F result;
 
     for (U32 r = 0; r < 4; ++r) {
         for (U32 c = 0; c < 4; ++c) {
@@ -308,6 +572,33 @@ Mat4x4F M4x4FMul(Mat4x4F a, Mat4x4F b) {
     return result;
 }
 
+Mat3x4F M3x4FMul(Mat3x4F a, Mat3x4F b) {
+    Mat3x4F result;
+
+    for (U32 r = 0; r < 3; ++r) {
+        for (U32 c = 0; c < 4; ++c) {
+            result.m[r][c] = (a.m[r][0] * b.m[0][c]) + (a.m[r][1] * b.m[1][c]) + (a.m[r][2] * b.m[2][c]);
+        }
+
+        result.m[r][3] += a.m[r][3];
+    }
+
+    return result;
+}
+
+// :note no non-temporal stores, the matrix is written with regular stores
+//
+void M3x4FMulStream(Mat3x4F *output, Mat3x4F a, Mat3x4F b) {
+    Assert((cast(U64) output & 15) == 0);
+
+    *output = M3x4FMul(a, b);
+}
+
+void StoreFence() {
+}
+
+#endif
+
 Vec3F M4x4FMulV3F(Mat4x4F a, Vec3F b) {
     Vec4F v = V4F(b.x, b.y, b.z, 1.0f);
 
@@ -374,6 +665,15 @@ F32 Q4FDot(Quat4F a, Quat4F b) {
     return result;
 }
 
+Vec3F V3FCross(Vec3F a, Vec3F b) {
+    Vec3F result;
+    result.x = (a.y * b.z) - (a.z * b.y);
+    result.y = (a.z * b.x) - (a.x * b.z);
+    result.z = (a.x * b.y) - (a.y * b.x);
+
+    return result;
+}
+
 Vec3F V3FNormalize(Vec3F a) {
     Vec3F result = V3F(0, 0, 0);
 
@@ -431,3 +731,355 @@ Mat4x4F M4x4FTranslateV3F(Mat4x4F m, Vec3F v) {
 
     return result;
 }
+
+Transform3F T3FInverse(Transform3F t) {
+    Transform3F result;
+
+    result.orientation = Q4FConjugate(t.orientation);
+    result.scale       = V3F(1.0f / t.scale.x, 1.0f / t.scale.y, 1.0f / t.scale.z);
+
+    // (S^-1 * R^-1 * T^-1) applied to the origin
+    //
+    result.position = V3FHadamard(result.scale, Q4FMulV3F(result.orientation, V3FNeg(t.position)));
+
+    return result;
+}
+
+Mat3x4F M3x4FInverse(Mat3x4F m) {
+    Mat3x4F result;
+
+    // inverse of the upper 3x3 is (adjugate / determinant), the cofactors of the first row are shared with the
+    // determinant
+    //
+    F32 c00 = (m.m[1][1] * m.m[2][2]) - (m.m[1][2] * m.m[2][1]);
+    F32 c01 = (m.m[1][2] * m.m[2][0]) - (m.m[1][0] * m.m[2][2]);
+    F32 c02 = (m.m[1][0] * m.m[2][1]) - (m.m[1][1] * m.m[2][0]);
+
+    F32 det = (m.m[0][0] * c00) + (m.m[0][1] * c01) + (m.m[0][2] * c02);
+
+    if (det == 0) {
+        result = M3x4FIdentity();
+    }
+    else {
+        F32 inv_det = 1.0f / det;
+
+        result.m[0][0] = c00 * inv_det;
+        result.m[0][1] = ((m.m[0][2] * m.m[2][1]) - (m.m[0][1] * m.m[2][2])) * inv_det;
+        result.m[0][2] = ((m.m[0][1] * m.m[1][2]) - (m.m[0][2] * m.m[1][1])) * inv_det;
+
+        result.m[1][0] = c01 * inv_det;
+        result.m[1][1] = ((m.m[0][0] * m.m[2][2]) - (m.m[0][2] * m.m[2][0])) * inv_det;
+        result.m[1][2] = ((m.m[0][2] * m.m[1][0]) - (m.m[0][0] * m.m[1][2])) * inv_det;
+
+        result.m[2][0] = c02 * inv_det;
+        result.m[2][1] = ((m.m[0][1] * m.m[2][0]) - (m.m[0][0] * m.m[2][1])) * inv_det;
+        result.m[2][2] = ((m.m[0][0] * m.m[1][1]) - (m.m[0][1] * m.m[1][0])) * inv_det;
+
+        // the translation is undone after the inverse of the 3x3, -(inverse * t)
+        //
+        for (U32 r = 0; r < 3; ++r) {
+            result.m[r][3] = -((result.m[r][0] * m.m[0][3]) + (result.m[r][1] * m.m[1][3]) + (result.m[r][2] * m.m[2][3]));
+        }
+    }
+
+    return result;
+}
+
+// Wide math
+//
+#if WIDE_LANES == 8
+
+WideF32 WideF32Set1(F32 x) {
+    WideF32 result = _mm256_set1_ps(x);
+    return result;
+}
+
+WideF32 WideF32Load(F32 *p) {
+    WideF32 result = _mm256_load_ps(p);
+    return result;
+}
+
+WideF32 WideF32LoadStrided(F32 *p, U32 stride) {
+    __m256i lanes   = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i offsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(cast(S32) stride));
+
+    WideF32 result = _mm256_i32gather_ps(p, offsets, sizeof(F32));
+    return result;
+}
+
+void WideF32Store(F32 *p, WideF32 x) {
+    _mm256_store_ps(p, x);
+}
+
+WideF32 WideF32Add(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_add_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Sub(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_sub_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Mul(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_mul_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Div(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_div_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Sqrt(WideF32 a) {
+    WideF32 result = _mm256_sqrt_ps(a);
+    return result;
+}
+
+WideF32 WideF32Min(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_min_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Max(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_max_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Truncate(WideF32 a) {
+    WideF32 result = _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    return result;
+}
+
+WideF32 WideF32And(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_and_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Xor(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_xor_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32LessThan(WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    return result;
+}
+
+WideF32 WideF32Select(WideF32 mask, WideF32 a, WideF32 b) {
+    WideF32 result = _mm256_blendv_ps(b, a, mask);
+    return result;
+}
+
+WideF32 WideF32MaskFromBits(U32 bits) {
+    __m256i lanes = _mm256_setr_epi32(1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7);
+    __m256i set   = _mm256_and_si256(_mm256_set1_epi32(bits), lanes);
+
+    WideF32 result = _mm256_castsi256_ps(_mm256_cmpeq_epi32(set, lanes));
+    return result;
+}
+
+#elif WIDE_LANES == 4
+
+WideF32 WideF32Set1(F32 x) {
+    WideF32 result = _mm_set1_ps(x);
+    return result;
+}
+
+WideF32 WideF32Load(F32 *p) {
+    WideF32 result = _mm_load_ps(p);
+    return result;
+}
+
+WideF32 WideF32LoadStrided(F32 *p, U32 stride) {
+    WideF32 result = _mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]);
+    return result;
+}
+
+void WideF32Store(F32 *p, WideF32 x) {
+    _mm_store_ps(p, x);
+}
+
+WideF32 WideF32Add(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_add_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Sub(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_sub_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Mul(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_mul_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Div(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_div_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Sqrt(WideF32 a) {
+    WideF32 result = _mm_sqrt_ps(a);
+    return result;
+}
+
+WideF32 WideF32Min(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_min_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Max(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_max_ps(a, b);
+    return result;
+}
+
+// :note sse2 doesn't have a rounding instruction so this goes through a 32-bit integer
+//
+WideF32 WideF32Truncate(WideF32 a) {
+    WideF32 result = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return result;
+}
+
+WideF32 WideF32And(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_and_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Xor(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_xor_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32LessThan(WideF32 a, WideF32 b) {
+    WideF32 result = _mm_cmplt_ps(a, b);
+    return result;
+}
+
+WideF32 WideF32Select(WideF32 mask, WideF32 a, WideF32 b) {
+    WideF32 result = _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    return result;
+}
+
+WideF32 WideF32MaskFromBits(U32 bits) {
+    __m128i lanes = _mm_setr_epi32(1 << 0, 1 << 1, 1 << 2, 1 << 3);
+    __m128i set   = _mm_and_si128(_mm_set1_epi32(bits), lanes);
+
+    WideF32 result = _mm_castsi128_ps(_mm_cmpeq_epi32(set, lanes));
+    return result;
+}
+
+#else
+
+// :note the scalar fallback still needs to support the bitwise operations for masks so we reinterpret the
+// floats as integers
+//
+FileScope U32 WideF32Bits(F32 x) {
+    U32 result;
+    MemoryCopy(&result, &x, sizeof(U32));
+
+    return result;
+}
+
+FileScope F32 WideF32FromBits(U32 x) {
+    F32 result;
+    MemoryCopy(&result, &x, sizeof(F32));
+
+    return result;
+}
+
+WideF32 WideF32Set1(F32 x) {
+    WideF32 result = x;
+    return result;
+}
+
+WideF32 WideF32Load(F32 *p) {
+    WideF32 result = *p;
+    return result;
+}
+
+WideF32 WideF32LoadStrided(F32 *p, U32 stride) {
+    (void) stride;
+
+    WideF32 result = p[0];
+    return result;
+}
+
+void WideF32Store(F32 *p, WideF32 x) {
+    *p = x;
+}
+
+WideF32 WideF32Add(WideF32 a, WideF32 b) {
+    WideF32 result = a + b;
+    return result;
+}
+
+WideF32 WideF32Sub(WideF32 a, WideF32 b) {
+    WideF32 result = a - b;
+    return result;
+}
+
+WideF32 WideF32Mul(WideF32 a, WideF32 b) {
+    WideF32 result = a * b;
+    return result;
+}
+
+WideF32 WideF32Div(WideF32 a, WideF32 b) {
+    WideF32 result = a / b;
+    return result;
+}
+
+WideF32 WideF32Sqrt(WideF32 a) {
+    WideF32 result = sqrtf(a);
+    return result;
+}
+
+WideF32 WideF32Min(WideF32 a, WideF32 b) {
+    WideF32 result = Min(a, b);
+    return result;
+}
+
+WideF32 WideF32Max(WideF32 a, WideF32 b) {
+    WideF32 result = Max(a, b);
+    return result;
+}
+
+WideF32 WideF32Truncate(WideF32 a) {
+    WideF32 result = cast(F32) cast(S32) a;
+    return result;
+}
+
+WideF32 WideF32And(WideF32 a, WideF32 b) {
+    WideF32 result = WideF32FromBits(WideF32Bits(a) & WideF32Bits(b));
+    return result;
+}
+
+WideF32 WideF32Xor(WideF32 a, WideF32 b) {
+    WideF32 result = WideF32FromBits(WideF32Bits(a) ^ WideF32Bits(b));
+    return result;
+}
+
+WideF32 WideF32LessThan(WideF32 a, WideF32 b) {
+    WideF32 result = WideF32FromBits((a < b) ? U32_MAX : 0);
+    return result;
+}
+
+WideF32 WideF32Select(WideF32 mask, WideF32 a, WideF32 b) {
+    WideF32 result = (WideF32Bits(mask) != 0) ? a : b;
+    return result;
+}
+
+WideF32 WideF32MaskFromBits(U32 bits) {
+    WideF32 result = WideF32FromBits((bits & 1) ? U32_MAX : 0);
+    return result;
+}
+
+#endif
+
+WideF32 WideF32Lerp(WideF32 a, WideF32 b, WideF32 t) {
+    WideF32 one    = WideF32Set1(1.0f);
+    WideF32 result = WideF32Add(WideF32Mul(WideF32Sub(one, t), a), WideF32Mul(t, b));
+
+    return result;
+}
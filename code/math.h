@@ -42,6 +42,14 @@ union Mat4x4F {
     Vec4F r[4];
 };
 
+// Affine transform stored as the top three rows of a row-major 4x4 matrix, the bottom row is always (0, 0, 0, 1)
+//
+union Mat3x4F {
+    F32   m[3][4];
+    F32   e[12];
+    Vec4F r[3];
+};
+
 struct Mat4x4FInv {
     Mat4x4F fwd;
     Mat4x4F inv;
@@ -65,6 +73,17 @@ union Quat4F {
     F32 e[4];
 };
 
+// Quaternion, vector, scale transform applied as (T * R * S), which is the matrix T3FToM3x4F produces
+//
+// :note composing transforms multiplies the scales per axis which is only exact when the parent has uniform scale,
+// a rotated child of a non-uniformly scaled parent would need shear to represent and that is dropped
+//
+struct Transform3F {
+    Vec3F  position;
+    Quat4F orientation;
+    Vec3F  scale;
+};
+
 // Construction
 //
 Func Vec3F V3F(F32 x, F32 y, F32 z);
@@ -72,6 +91,9 @@ Func Vec4F V4F(F32 x, F32 y, F32 z, F32 w);
 
 Func Quat4F  Q4FIdentity();
 Func Mat4x4F M4x4FIdentity();
+Func Mat3x4F M3x4FIdentity();
+
+Func Transform3F T3FIdentity();
 
 Func Mat4x4F M4x4FRotationX(F32 turns);
 Func Mat4x4F M4x4FRotationY(F32 turns);
@@ -87,6 +109,14 @@ Func Mat4x4FInv M4x4FCameraViewProjection(Vec3F x, Vec3F y, Vec3F z, Vec3F p);
 // Conversion
 //
 Func Mat4x4F Q4FToM4x4F(Quat4F q);
+Func Mat3x4F Q4FToM3x4F(Quat4F q);
+
+Func Mat3x4F T3FToM3x4F(Transform3F t);
+
+// IEEE half precision stored in the low 16 bits, rounds to nearest even. values too large for a half become infinity
+//
+Func U16 F32ToF16(F32 x);
+Func F32 F16ToF32(U16 x);
 
 // Operators
 //
@@ -103,8 +133,26 @@ Func Vec4F V4FHadamard(Vec4F a, Vec4F b);
 Func Vec3F V3FScale(Vec3F a, F32 b);
 Func Vec4F V4FScale(Vec4F a, F32 b);
 
+Func Quat4F Q4FMul(Quat4F a, Quat4F b);
+Func Quat4F Q4FConjugate(Quat4F a);
+
+Func Vec3F Q4FMulV3F(Quat4F q, Vec3F v); // rotates v, q must be normalised
+
+// The child b in the space of the parent a
+//
+Func Transform3F T3FMul(Transform3F a, Transform3F b);
+Func Vec3F       T3FMulV3F(Transform3F a, Vec3F b); // b is a point
+
 Func Mat4x4F M4x4FMul(Mat4x4F a, Mat4x4F b);
 
+Func Mat3x4F M3x4FMul(Mat3x4F a, Mat3x4F b);
+
+// Writes (a * b) to output from registers with non-temporal stores, output is never read so it can be write-combined
+// memory. output must be aligned to 16 bytes and StoreFence must be called before anything else reads it
+//
+Func void M3x4FMulStream(Mat3x4F *output, Mat3x4F a, Mat3x4F b);
+Func void StoreFence();
+
 Func Vec3F M4x4FMulV3F(Mat4x4F a, Vec3F b);
 Func Vec4F M4x4FMulV4F(Mat4x4F a, Vec4F b);
 
@@ -119,6 +167,8 @@ Func F32 V3FDot(Vec3F  a, Vec3F  b);
 Func F32 V4FDot(Vec4F  a, Vec4F  b);
 Func F32 Q4FDot(Quat4F a, Quat4F b);
 
+Func Vec3F V3FCross(Vec3F a, Vec3F b);
+
 Func Vec3F  V3FNormalize(Vec3F  a);
 Func Vec4F  V4FNormalize(Vec4F  a);
 Func Quat4F Q4FNormalize(Quat4F a);
@@ -128,4 +178,64 @@ Func Vec4F M4x4FColumnExtract(Mat4x4F m, U32 c);
 
 Func Mat4x4F M4x4FTranslateV3F(Mat4x4F m, Vec3F v);
 
+// Inverse of the full affine transform, rotation, scale and shear included. singular matrices return identity
+//
+Func Mat3x4F M3x4FInverse(Mat3x4F m);
+
+// Exact for uniform scale, see the note on Transform3F
+//
+Func Transform3F T3FInverse(Transform3F t);
+
+// Wide math
+//
+// Operates on WIDE_LANES floats at a time, this is 8 lanes when compiled with avx2, 4 lanes with sse2 (which is
+// always available on amd64) and falls back to a single scalar lane elsewhere. code written in terms of these
+// types will work regardless of the lane count, as long as arrays are padded to a multiple of WIDE_MAX_LANES
+//
+// Masks are returned from the comparison functions with all bits set in the lanes where the comparison was true
+//
+#define WIDE_MAX_LANES 8
+
+#if ARCH_AMD64
+    #include <immintrin.h>
+
+    #if defined(__AVX2__)
+        #define WIDE_LANES 8
+        typedef __m256 WideF32;
+    #else
+        #define WIDE_LANES 4
+        typedef __m128 WideF32;
+    #endif
+#else
+    #define WIDE_LANES 1
+    typedef F32 WideF32;
+#endif
+
+Func WideF32 WideF32Set1(F32 x);
+
+Func WideF32 WideF32Load(F32 *p);                     // p must be aligned to (WIDE_LANES * sizeof(F32))
+Func WideF32 WideF32LoadStrided(F32 *p, U32 stride);  // lane n is loaded from p[n * stride]
+Func void    WideF32Store(F32 *p, WideF32 x);         // p must be aligned to (WIDE_LANES * sizeof(F32))
+
+Func WideF32 WideF32Add(WideF32 a, WideF32 b);
+Func WideF32 WideF32Sub(WideF32 a, WideF32 b);
+Func WideF32 WideF32Mul(WideF32 a, WideF32 b);
+Func WideF32 WideF32Div(WideF32 a, WideF32 b);
+Func WideF32 WideF32Sqrt(WideF32 a);
+
+Func WideF32 WideF32Min(WideF32 a, WideF32 b);  // same as the Min/Max macros, b is returned if either is nan
+Func WideF32 WideF32Max(WideF32 a, WideF32 b);
+
+Func WideF32 WideF32Truncate(WideF32 a);       // rounds toward zero, a must be within the range of a S32
+
+Func WideF32 WideF32And(WideF32 a, WideF32 b);
+Func WideF32 WideF32Xor(WideF32 a, WideF32 b);
+
+Func WideF32 WideF32LessThan(WideF32 a, WideF32 b);
+
+Func WideF32 WideF32Select(WideF32 mask, WideF32 a, WideF32 b); // a in the lanes where mask is set, otherwise b
+Func WideF32 WideF32MaskFromBits(U32 bits);                     // lane n is set if bit n is set
+
+Func WideF32 WideF32Lerp(WideF32 a, WideF32 b, WideF32 t);
+
 #endif  // ANIM_MATH_H_
@@ -73,6 +73,75 @@ Func void OS_DirectoryDelete(Str8 path);
 Func OS_FileInfo OS_FileInfoFromPath(Arena *arena, Str8 path);
 Func OS_FileInfo OS_FileInfoFromHandle(Arena *arena, OS_Handle file);
 
+// Read-only view of an entire file, the data stays valid until OS_FileUnmap is called. pages are only read from
+// disk when they are first touched and are shared with the page cache rather than being copied into process memory
+//
+typedef struct OS_FileMapping OS_FileMapping;
+struct OS_FileMapping {
+    OS_Handle handle; // platform specific mapping object, if required
+
+    Str8 data;
+};
+
+// data is empty if the file doesn't exist, is empty or couldn't be mapped
+//
+Func OS_FileMapping OS_FileMap(Str8 path);
+Func void OS_FileUnmap(OS_FileMapping *mapping);
+
+// Asynchronous reads
+//
+// Reads are submitted to a queue and run in the background, they are checked for completion with OS_AsyncReadPoll
+// or waited on with OS_AsyncReadWait. the read and the memory it is reading into must stay valid until the read is
+// no longer pending. on linux io_uring is used when it is available, otherwise, and on other platforms, each read
+// is run as a job, see JobPush
+//
+// :note a queue must only be used from a single thread, that thread must either be the one that called
+// JobSystemInit or be running a job. if the job system isn't running reads that are run as jobs will complete
+// before OS_AsyncReadSubmit returns
+//
+typedef U32 OS_AsyncReadState;
+enum {
+    OS_ASYNC_READ_STATE_NONE = 0,
+    OS_ASYNC_READ_STATE_PENDING,
+    OS_ASYNC_READ_STATE_COMPLETE,
+    OS_ASYNC_READ_STATE_FAILED  // error or end of file was reached before size bytes were read
+};
+
+typedef struct OS_AsyncRead OS_AsyncRead;
+struct OS_AsyncRead {
+    OS_Handle file;
+
+    void *data;
+    U64   offset;
+    U64   size;
+
+    volatile OS_AsyncReadState state;
+
+    U64 nread; // internal, bytes read so far
+};
+
+typedef struct OS_AsyncQueue OS_AsyncQueue;
+struct OS_AsyncQueue {
+    OS_Handle handle; // platform specific, zero if reads are run as jobs
+
+    U32 max_reads;
+    U32 num_pending;
+
+    JobCounter counter; // reads that are running as jobs
+};
+
+// max_reads is the maximum number of reads that can be in flight at any one time
+//
+Func void OS_AsyncQueueCreate(Arena *arena, OS_AsyncQueue *queue, U32 max_reads);
+Func void OS_AsyncQueueDestroy(OS_AsyncQueue *queue); // waits for any reads that are still pending
+
+Func B32  OS_AsyncReadSubmit(OS_AsyncQueue *queue, OS_AsyncRead *read); // false if max_reads are already in flight
+Func U32  OS_AsyncReadPoll(OS_AsyncQueue *queue);                       // non-blocking, returns the number pending
+
+// :note when reads are run as jobs this waits for every read submitted to the queue, not just the one provided
+//
+Func void OS_AsyncReadWait(OS_AsyncQueue *queue, OS_AsyncRead *read);
+
 typedef U32 OS_FileIterFlags;
 enum {
     OS_FILE_ITER_SKIP_DIRECTORIES = (1 << 0),
@@ -454,6 +523,121 @@ OS_FileInfo OS_FileInfoFromHandle(Arena *arena, OS_Handle file) {
     return result;
 }
 
+OS_FileMapping OS_FileMap(Str8 path) {
+    OS_FileMapping result = { 0 };
+
+    TempArena temp = TempGet(0, 0);
+    Str8 wpath     = Win32_Str8ConvertToStr16(temp.arena, path);
+
+    HANDLE file = CreateFileW((LPCWSTR) wpath.data, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+
+        // zero sized files can't be mapped
+        //
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingW(file, 0, PAGE_READONLY, 0, 0, 0);
+            if (mapping) {
+                void *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (base) {
+                    result.handle.v   = cast(U64) mapping;
+                    result.data.count = size.QuadPart;
+                    result.data.data  = cast(U8 *) base;
+                }
+                else {
+                    CloseHandle(mapping);
+                }
+            }
+        }
+
+        // the mapping holds its own reference to the file
+        //
+        CloseHandle(file);
+    }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+void OS_FileUnmap(OS_FileMapping *mapping) {
+    if (mapping->data.data) {
+        UnmapViewOfFile(mapping->data.data);
+        CloseHandle(cast(HANDLE) mapping->handle.v);
+    }
+
+    StructZero(mapping);
+}
+
+// @todo: this could use overlapped io with a completion port instead of blocking a worker for each read
+//
+FileScope void Win32_AsyncReadRun(void *data) {
+    OS_AsyncRead *read = cast(OS_AsyncRead *) data;
+
+    HANDLE handle = cast(HANDLE) read->file.v;
+    B32    failed = (handle == INVALID_HANDLE_VALUE);
+
+    while (!failed && read->nread < read->size) {
+        U64 offset = read->offset + read->nread;
+
+        OVERLAPPED ov = { 0 };
+        ov.Offset     = cast(DWORD) (offset >>  0);
+        ov.OffsetHigh = cast(DWORD) (offset >> 32);
+
+        U64   remaining = read->size - read->nread;
+        DWORD to_read   = ((remaining > U32_MAX) ? U32_MAX : (DWORD) remaining);
+        DWORD nread     = 0;
+
+        if (!ReadFile(handle, cast(U8 *) read->data + read->nread, to_read, &nread, &ov) || nread == 0) {
+            failed = true;
+        }
+
+        read->nread += nread;
+    }
+
+    // the read can be released as soon as the state has changed so it mustn't be accessed after this
+    //
+    U32AtomicStore(&read->state, failed ? OS_ASYNC_READ_STATE_FAILED : OS_ASYNC_READ_STATE_COMPLETE);
+}
+
+void OS_AsyncQueueCreate(Arena *arena, OS_AsyncQueue *queue, U32 max_reads) {
+    (void) arena;
+
+    StructZero(queue);
+    queue->max_reads = max_reads;
+}
+
+void OS_AsyncQueueDestroy(OS_AsyncQueue *queue) {
+    JobCounterWait(&queue->counter);
+    StructZero(queue);
+}
+
+B32 OS_AsyncReadSubmit(OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    B32 result = false;
+
+    if (U32AtomicLoad(&queue->counter.remaining) < queue->max_reads) {
+        read->nread = 0;
+        read->state = OS_ASYNC_READ_STATE_PENDING;
+
+        JobPush(Win32_AsyncReadRun, read, &queue->counter);
+
+        result = true;
+    }
+
+    return result;
+}
+
+U32 OS_AsyncReadPoll(OS_AsyncQueue *queue) {
+    U32 result = U32AtomicLoad(&queue->counter.remaining);
+    return result;
+}
+
+void OS_AsyncReadWait(OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    if (U32AtomicLoad(&read->state) == OS_ASYNC_READ_STATE_PENDING) {
+        JobCounterWait(&queue->counter);
+    }
+}
+
 OS_FileList OS_DirectoryList(Arena *arena, Str8 path, OS_FileIterFlags flags) {
     OS_FileList result = { 0 };
 
@@ -664,6 +848,484 @@ VoidProc *OS_LibraryProcLoad(OS_Handle handle, Str8 name) {
 
 #elif OS_LINUX
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <linux/io_uring.h>
+
+//
+// --------------------------------------------------------------------------------
+// :Linux_File_System
+// --------------------------------------------------------------------------------
+//
+
+OS_Handle OS_FileOpen(Str8 path, OS_FileAccess access) {
+    OS_Handle result = { 0 };
+
+    TempArena temp = TempGet(0, 0);
+    char *zpath    = Str8PushCopyNullTerminated(temp.arena, path);
+
+    int flags = O_RDONLY;
+    if (access & OS_FILE_ACCESS_WRITE) {
+        flags = (access & OS_FILE_ACCESS_READ) ? O_RDWR : O_WRONLY;
+        flags |= O_CREAT;
+    }
+
+    // can be -1, the same as INVALID_HANDLE_VALUE on windows
+    //
+    int fd = open(zpath, flags | O_CLOEXEC, 0644);
+    result.v = cast(U64) cast(S64) fd;
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+void OS_FileClose(OS_Handle file) {
+    int fd = cast(int) file.v;
+    if (fd != -1) { close(fd); }
+}
+
+void OS_FileRead(OS_Handle file, void *data, U64 offset, U64 size) {
+    int fd = cast(int) file.v;
+    if (fd != -1) {
+        U64 current_offset = offset;
+        U64 size_remaining = size;
+
+        U8 *data_at = cast(U8 *) data;
+
+        while (size_remaining != 0) {
+            ssize_t nread = pread(fd, data_at, size_remaining, current_offset);
+            if (nread <= 0) {
+                if (nread < 0 && errno == EINTR) { continue; }
+
+                // Failed to read or reached the end of the file so bail
+                //
+                break;
+            }
+
+            size_remaining -= nread;
+            current_offset += nread;
+            data_at        += nread;
+        }
+    }
+}
+
+void OS_FileWrite(OS_Handle file, void *data, U64 offset, U64 size) {
+    int fd = cast(int) file.v;
+    if (fd != -1) {
+        U64 current_offset = offset;
+        U64 size_remaining = size;
+
+        U8 *data_at = cast(U8 *) data;
+
+        while (size_remaining != 0) {
+            ssize_t nwritten = pwrite(fd, data_at, size_remaining, current_offset);
+            if (nwritten <= 0) {
+                if (nwritten < 0 && errno == EINTR) { continue; }
+
+                // Failed to write so bail
+                //
+                break;
+            }
+
+            size_remaining -= nwritten;
+            current_offset += nwritten;
+            data_at        += nwritten;
+        }
+    }
+}
+
+B32 OS_FileExists(Str8 path) {
+    TempArena temp = TempGet(0, 0);
+    char *zpath    = Str8PushCopyNullTerminated(temp.arena, path);
+
+    struct stat info;
+    B32 result = (stat(zpath, &info) == 0) && S_ISREG(info.st_mode);
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+void OS_FileDelete(Str8 path) {
+    TempArena temp = TempGet(0, 0);
+    char *zpath    = Str8PushCopyNullTerminated(temp.arena, path);
+
+    unlink(zpath);
+
+    TempRelease(&temp);
+}
+
+OS_FileInfo OS_FileInfoFromHandle(Arena *arena, OS_Handle file) {
+    OS_FileInfo result = { 0 };
+
+    (void) arena;
+
+    int fd = cast(int) file.v;
+    if (fd != -1) {
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            // :note the name isn't filled in as there is no reliable way to get the path from a file descriptor
+            //
+            result.size            = info.st_size;
+            result.last_write_time = cast(U64) info.st_mtime;
+            result.creation_time   = cast(U64) info.st_ctime; // status change time, linux doesn't store creation
+
+            if (S_ISDIR(info.st_mode)) { result.props |= OS_FILE_PROPERTY_DIRECTORY; }
+        }
+    }
+
+    return result;
+}
+
+OS_FileMapping OS_FileMap(Str8 path) {
+    OS_FileMapping result = { 0 };
+
+    TempArena temp = TempGet(0, 0);
+    char *zpath    = Str8PushCopyNullTerminated(temp.arena, path);
+
+    int fd = open(zpath, O_RDONLY);
+    if (fd != -1) {
+        struct stat info;
+
+        // zero sized files can't be mapped
+        //
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void *base = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED) {
+                // files are mapped to be loaded so start reading the pages in now
+                //
+                madvise(base, info.st_size, MADV_WILLNEED);
+
+                result.data.count = info.st_size;
+                result.data.data  = cast(U8 *) base;
+            }
+        }
+
+        // the mapping holds its own reference to the file
+        //
+        close(fd);
+    }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+void OS_FileUnmap(OS_FileMapping *mapping) {
+    if (mapping->data.data) {
+        munmap(mapping->data.data, mapping->data.count);
+    }
+
+    StructZero(mapping);
+}
+
+// The submission and completion rings shared with the kernel, see io_uring(7). io_uring_setup is called directly
+// rather than depending on liburing
+//
+typedef struct Linux_Uring Linux_Uring;
+struct Linux_Uring {
+    int fd;
+
+    volatile U32 *sq_head;
+    volatile U32 *sq_tail;
+    U32 sq_mask;
+    U32 *sq_array;
+
+    struct io_uring_sqe *sqes;
+
+    volatile U32 *cq_head;
+    volatile U32 *cq_tail;
+    U32 cq_mask;
+
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring;
+    U64   sq_ring_size;
+
+    void *cq_ring;
+    U64   cq_ring_size;
+
+    U64 sqes_size;
+};
+
+// Reads larger than this are split, linux will never transfer more than this in a single read anyway
+//
+#define LINUX_MAX_READ_SIZE 0x7FFFF000
+
+FileScope B32 Linux_UringCreate(Linux_Uring *ring, U32 num_entries) {
+    B32 result = false;
+
+    struct io_uring_params params = { 0 };
+
+    // fails if the kernel doesn't support io_uring or it has been disabled
+    //
+    int fd = cast(int) syscall(__NR_io_uring_setup, num_entries, &params);
+    if (fd < 0) { return result; }
+
+    StructZero(ring);
+    ring->fd = fd;
+
+    // IORING_OP_READ was only added in 5.6, older kernels fall back to running reads as jobs
+    //
+    TempArena temp = TempGet(0, 0);
+
+    U64 probe_size = sizeof(struct io_uring_probe) + (IORING_OP_LAST * sizeof(struct io_uring_probe_op));
+    struct io_uring_probe *probe = cast(struct io_uring_probe *) ArenaPush(temp.arena, U8, probe_size);
+
+    B32 supported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0 &&
+        probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+
+    TempRelease(&temp);
+
+    if (supported) {
+        ring->sq_ring_size = params.sq_off.array + (params.sq_entries * sizeof(U32));
+        ring->cq_ring_size = params.cq_off.cqes  + (params.cq_entries * sizeof(struct io_uring_cqe));
+        ring->sqes_size    = params.sq_entries * sizeof(struct io_uring_sqe);
+
+        // newer kernels map both rings with a single mapping
+        //
+        B32 single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            ring->sq_ring_size = Max(ring->sq_ring_size, ring->cq_ring_size);
+            ring->cq_ring_size = ring->sq_ring_size;
+        }
+
+        U8 *sq_ring = cast(U8 *) mmap(0, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        U8 *cq_ring = sq_ring;
+
+        if (!single && sq_ring != MAP_FAILED) {
+            cq_ring = cast(U8 *) mmap(0, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        }
+
+        void *sqes = MAP_FAILED;
+        if (sq_ring != MAP_FAILED && cq_ring != MAP_FAILED) {
+            sqes = mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        }
+
+        if (sqes != MAP_FAILED) {
+            ring->sq_ring = sq_ring;
+            ring->cq_ring = cq_ring;
+
+            ring->sq_head  = cast(volatile U32 *) (sq_ring + params.sq_off.head);
+            ring->sq_tail  = cast(volatile U32 *) (sq_ring + params.sq_off.tail);
+            ring->sq_mask  = *cast(U32 *) (sq_ring + params.sq_off.ring_mask);
+            ring->sq_array = cast(U32 *) (sq_ring + params.sq_off.array);
+            ring->sqes     = cast(struct io_uring_sqe *) sqes;
+
+            ring->cq_head = cast(volatile U32 *) (cq_ring + params.cq_off.head);
+            ring->cq_tail = cast(volatile U32 *) (cq_ring + params.cq_off.tail);
+            ring->cq_mask = *cast(U32 *) (cq_ring + params.cq_off.ring_mask);
+            ring->cqes    = cast(struct io_uring_cqe *) (cq_ring + params.cq_off.cqes);
+
+            result = true;
+        }
+        else {
+            if (cq_ring != sq_ring && cq_ring != MAP_FAILED) { munmap(cq_ring, ring->cq_ring_size); }
+            if (sq_ring != MAP_FAILED) { munmap(sq_ring, ring->sq_ring_size); }
+        }
+    }
+
+    if (!result) { close(fd); }
+
+    return result;
+}
+
+FileScope void Linux_UringDestroy(Linux_Uring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+
+    if (ring->cq_ring != ring->sq_ring) { munmap(ring->cq_ring, ring->cq_ring_size); }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+
+    close(ring->fd);
+}
+
+// Submits every entry the kernel hasn't consumed yet, if wait is set this blocks until at least one read completes
+//
+FileScope void Linux_UringEnter(Linux_Uring *ring, B32 wait) {
+    U32 to_submit = *ring->sq_tail - U32AtomicLoad(ring->sq_head);
+
+    U32 min_complete = wait ? 1 : 0;
+    U32 flags        = wait ? IORING_ENTER_GETEVENTS : 0;
+
+    syscall(__NR_io_uring_enter, ring->fd, to_submit, min_complete, flags, 0, 0);
+}
+
+// Queues a read of the remaining data, each pending read only ever has one entry in flight so the rings can't
+// overflow as long as there are no more than max_reads pending
+//
+FileScope void Linux_UringReadPush(Linux_Uring *ring, OS_AsyncRead *read) {
+    U32 tail  = *ring->sq_tail;
+    U32 index = tail & ring->sq_mask;
+
+    U64 remaining = read->size - read->nread;
+
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    StructZero(sqe);
+
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = cast(int) read->file.v;
+    sqe->addr      = cast(U64) (cast(U8 *) read->data + read->nread);
+    sqe->len       = cast(U32) Min(remaining, LINUX_MAX_READ_SIZE);
+    sqe->off       = read->offset + read->nread;
+    sqe->user_data = cast(U64) read;
+
+    ring->sq_array[index] = index;
+
+    U32AtomicStore(ring->sq_tail, tail + 1);
+
+    Linux_UringEnter(ring, false);
+}
+
+FileScope void Linux_UringReap(OS_AsyncQueue *queue, Linux_Uring *ring) {
+    U32 head = *ring->cq_head;
+    U32 tail = U32AtomicLoad(ring->cq_tail);
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+
+        OS_AsyncRead *read = cast(OS_AsyncRead *) cqe->user_data;
+        S32 res = cqe->res;
+
+        head += 1;
+        U32AtomicStore(ring->cq_head, head);
+
+        OS_AsyncReadState state = OS_ASYNC_READ_STATE_PENDING;
+
+        if (res > 0) {
+            read->nread += res;
+            if (read->nread == read->size) { state = OS_ASYNC_READ_STATE_COMPLETE; }
+        }
+        else if (res != -EINTR && res != -EAGAIN) {
+            // zero means the end of the file was reached before everything was read
+            //
+            state = OS_ASYNC_READ_STATE_FAILED;
+        }
+
+        if (state == OS_ASYNC_READ_STATE_PENDING) {
+            // short read or interrupted, read whatever is left
+            //
+            Linux_UringReadPush(ring, read);
+        }
+        else {
+            queue->num_pending -= 1;
+            U32AtomicStore(&read->state, state);
+        }
+    }
+}
+
+FileScope void Linux_AsyncReadRun(void *data) {
+    OS_AsyncRead *read = cast(OS_AsyncRead *) data;
+
+    int fd     = cast(int) read->file.v;
+    B32 failed = (fd == -1);
+
+    while (!failed && read->nread < read->size) {
+        U64 remaining = read->size - read->nread;
+
+        ssize_t nread = pread(fd, cast(U8 *) read->data + read->nread, remaining, read->offset + read->nread);
+        if (nread > 0) {
+            read->nread += nread;
+        }
+        else if (nread == 0 || errno != EINTR) {
+            failed = true;
+        }
+    }
+
+    // the read can be released as soon as the state has changed so it mustn't be accessed after this
+    //
+    U32AtomicStore(&read->state, failed ? OS_ASYNC_READ_STATE_FAILED : OS_ASYNC_READ_STATE_COMPLETE);
+}
+
+void OS_AsyncQueueCreate(Arena *arena, OS_AsyncQueue *queue, U32 max_reads) {
+    StructZero(queue);
+    queue->max_reads = max_reads;
+
+    Linux_Uring ring;
+    if (Linux_UringCreate(&ring, max_reads)) {
+        queue->handle.v = cast(U64) ArenaPushCopy(arena, &ring, Linux_Uring);
+    }
+}
+
+void OS_AsyncQueueDestroy(OS_AsyncQueue *queue) {
+    Linux_Uring *ring = cast(Linux_Uring *) queue->handle.v;
+    if (ring) {
+        while (queue->num_pending != 0) {
+            Linux_UringEnter(ring, true);
+            Linux_UringReap(queue, ring);
+        }
+
+        Linux_UringDestroy(ring);
+    }
+    else {
+        JobCounterWait(&queue->counter);
+    }
+
+    StructZero(queue);
+}
+
+B32 OS_AsyncReadSubmit(OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    B32 result = false;
+
+    Linux_Uring *ring = cast(Linux_Uring *) queue->handle.v;
+
+    U32 num_pending = ring ? queue->num_pending : U32AtomicLoad(&queue->counter.remaining);
+    if (num_pending < queue->max_reads) {
+        read->nread = 0;
+        read->state = OS_ASYNC_READ_STATE_PENDING;
+
+        if (read->size == 0) {
+            read->state = OS_ASYNC_READ_STATE_COMPLETE;
+        }
+        else if (ring) {
+            queue->num_pending += 1;
+            Linux_UringReadPush(ring, read);
+        }
+        else {
+            JobPush(Linux_AsyncReadRun, read, &queue->counter);
+        }
+
+        result = true;
+    }
+
+    return result;
+}
+
+U32 OS_AsyncReadPoll(OS_AsyncQueue *queue) {
+    U32 result;
+
+    Linux_Uring *ring = cast(Linux_Uring *) queue->handle.v;
+    if (ring) {
+        Linux_UringReap(queue, ring);
+        result = queue->num_pending;
+    }
+    else {
+        result = U32AtomicLoad(&queue->counter.remaining);
+    }
+
+    return result;
+}
+
+void OS_AsyncReadWait(OS_AsyncQueue *queue, OS_AsyncRead *read) {
+    Linux_Uring *ring = cast(Linux_Uring *) queue->handle.v;
+    if (ring) {
+        Linux_UringReap(queue, ring);
+
+        while (read->state == OS_ASYNC_READ_STATE_PENDING) {
+            Linux_UringEnter(ring, true);
+            Linux_UringReap(queue, ring);
+        }
+    }
+    else if (U32AtomicLoad(&read->state) == OS_ASYNC_READ_STATE_PENDING) {
+        JobCounterWait(&queue->counter);
+    }
+}
+
 #elif OS_SWITCH
 
 #endif
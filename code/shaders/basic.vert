@@ -36,9 +36,12 @@ readonly buffer Vertices {
     Vertex vertices[];
 };
 
+// the bottom row of a bone matrix is always (0, 0, 0, 1) so only the top three rows are uploaded, as row major this
+// is three vec4s per matrix matching Mat3x4F
+//
 layout(binding = 1, std430, row_major)
 readonly buffer Bones {
-    mat4 bones[];
+    mat4x3 bones[];
 };
 
 layout(location = 0) out vec2 frag_uv;
@@ -50,20 +53,20 @@ void main() {
     Vertex vertex = vertices[gl_VertexIndex];
 
     vec3 local_position = vertex.position;
-    vec4 position = vec4(0, 0, 0, 0);
+    vec3 position = vec3(0, 0, 0);
 
 #if 1
     for (int it = 0; it < 4; ++it) {
         position += (vertex.weights[it] / 255.0) * (bones[vertex.indices[it]] * vec4(local_position, 1.0));
     }
 #else
-    position = vec4(local_position, 1.0);
+    position = local_position;
 #endif
 
-    gl_Position = setup.view_proj * vec4(position.xyz, 1.0);
+    gl_Position = setup.view_proj * vec4(position, 1.0);
 
     frag_uv        = vec2(vertex.u,  vertex.v) / 65535.0;
     frag_normal    = (vec3(vertex.nx, vertex.ny, vertex.nz) / 127.0) - 1.0;
-    frag_pos       = position.xyz;
+    frag_pos       = position;
     material_index = vertex.material_index;
 }
@@ -0,0 +1,279 @@
+// Checks the optimised paths in the runtime against the scalar versions they replace
+//
+// usage:
+//     verify
+//
+// every check is run with fixed seeds so failures are reproducible, returns non-zero if any check fails
+//
+#define ANIMATION_TOOL 1
+#include "animation.cpp"
+
+// Relative to the magnitude of the values, the wide kernels perform the same operations in the same order as the
+// scalar versions so these only allow for the compiler contracting the scalar math into fused multiply-adds
+//
+#define VERIFY_TOLERANCE 0.000001f
+
+// xorshift, so the inputs don't depend on the c runtime
+//
+FileScope U32 VerifyRandomU32(U32 *state) {
+    U32 x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    *state = x;
+    return x;
+}
+
+FileScope F32 VerifyRandomF32(U32 *state, F32 min, F32 max) {
+    F32 t      = cast(F32) (VerifyRandomU32(state) >> 8) / cast(F32) (1 << 24);
+    F32 result = min + ((max - min) * t);
+
+    return result;
+}
+
+FileScope A_Sample VerifySampleRandom(U32 *state) {
+    A_Sample result;
+
+    result.position.x = VerifyRandomF32(state, -2.0f, 2.0f);
+    result.position.y = VerifyRandomF32(state, -2.0f, 2.0f);
+    result.position.z = VerifyRandomF32(state, -2.0f, 2.0f);
+
+    Quat4F q;
+    q.w = VerifyRandomF32(state, -1.0f, 1.0f);
+    q.x = VerifyRandomF32(state, -1.0f, 1.0f);
+    q.y = VerifyRandomF32(state, -1.0f, 1.0f);
+    q.z = VerifyRandomF32(state, -1.0f, 1.0f);
+
+    result.orientation = Q4FNormalize(q);
+
+    result.scale.x = VerifyRandomF32(state, 0.5f, 1.5f);
+    result.scale.y = VerifyRandomF32(state, 0.5f, 1.5f);
+    result.scale.z = VerifyRandomF32(state, 0.5f, 1.5f);
+
+    return result;
+}
+
+FileScope F32 VerifySampleError(A_Sample *a, A_Sample *b) {
+    F32 result = 0;
+
+    F32 *ea = cast(F32 *) a;
+    F32 *eb = cast(F32 *) b;
+
+    for (U32 it = 0; it < (sizeof(A_Sample) / sizeof(F32)); ++it) {
+        F32 scale = Max(1.0f, (ea[it] < 0) ? -ea[it] : ea[it]);
+        F32 diff  = eb[it] - ea[it];
+
+        result = Max(result, ((diff < 0) ? -diff : diff) / scale);
+    }
+
+    return result;
+}
+
+// A_PoseLerp against A_SampleLerp for every bone. the bone count isn't a multiple of the lane count so the tail
+// of the pose is covered, and the orientations in every third bone of b are negated so each block of lanes has a
+// mix of lanes that do and don't take the double cover flip
+//
+FileScope B32 VerifyPoseLerp(Arena *arena) {
+    B32 result = true;
+
+    TempArena temp = TempGet(1, &arena);
+
+    U32 state     = 0x9E3779B9;
+    U32 num_bones = 67;
+
+    A_Sample *a        = ArenaPush(temp.arena, A_Sample, num_bones);
+    A_Sample *b        = ArenaPush(temp.arena, A_Sample, num_bones);
+    A_Sample *expected = ArenaPush(temp.arena, A_Sample, num_bones);
+    A_Sample *actual   = ArenaPush(temp.arena, A_Sample, num_bones);
+
+    A_Pose pose_a = A_PosePush(temp.arena, num_bones);
+    A_Pose pose_b = A_PosePush(temp.arena, num_bones);
+    A_Pose output = A_PosePush(temp.arena, num_bones);
+
+    F32 times[] = { 0.0f, 1.0f, 0.5f, 0.25f, 0.8f, 0.333333f };
+
+    U32 num_flipped = 0;
+    U32 num_failed  = 0;
+    F32 max_error   = 0;
+
+    for (U32 round = 0; round < 64; ++round) {
+        for (U32 it = 0; it < num_bones; ++it) {
+            a[it] = VerifySampleRandom(&state);
+            b[it] = VerifySampleRandom(&state);
+
+            // make sure the flip is taken in these lanes regardless of the random orientations
+            //
+            B32 flip = (it % 3) == 0;
+            if (flip != (Q4FDot(a[it].orientation, b[it].orientation) < 0)) {
+                b[it].orientation = Q4FNeg(b[it].orientation);
+            }
+        }
+
+        A_PoseFromSamples(&pose_a, a);
+        A_PoseFromSamples(&pose_b, b);
+
+        for (U32 t = 0; t < ArraySize(times); ++t) {
+            A_PoseLerp(&output, &pose_a, &pose_b, times[t], 0);
+            A_PoseToSamples(actual, &output);
+
+            for (U32 it = 0; it < num_bones; ++it) {
+                expected[it] = A_SampleLerp(&a[it], &b[it], times[t]);
+
+                F32 error = VerifySampleError(&expected[it], &actual[it]);
+                if (error > VERIFY_TOLERANCE) { num_failed += 1; }
+
+                max_error    = Max(max_error, error);
+                num_flipped += (Q4FDot(a[it].orientation, b[it].orientation) < 0) ? 1 : 0;
+            }
+        }
+    }
+
+    printf("Pose lerp:\n");
+    printf("    - %d lanes, %d samples (%d double cover flips)\n", WIDE_LANES, 64 * num_bones * cast(U32) ArraySize(times), num_flipped);
+    printf("    - max error %g, tolerance %g\n", max_error, VERIFY_TOLERANCE);
+    printf("    - %d samples outside tolerance\n", num_failed);
+
+    if (num_failed != 0) { result = false; }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+FileScope F32 VerifyNaN() {
+    union { U32 u; F32 f; } bits;
+    bits.u = 0x7FC00000;
+
+    F32 result = bits.f;
+    return result;
+}
+
+// VerticesCook and SkinnedVerticesCook against VertexCook and SkinnedVertexCook, the outputs have to be identical
+// so they are compared bit-for-bit. the uvs and normals are generated outside of their valid range and every few
+// vertices has a nan in one of its components. the weights cycle through vertices with all zero, negative, tied,
+// normalised and unnormalised weights, and the quantised weights of every vertex have to sum to 255
+//
+FileScope B32 VerifyVertexCook(Arena *arena) {
+    B32 result = true;
+
+    TempArena temp = TempGet(1, &arena);
+
+    U32 state        = 0x2545F491;
+    U32 num_vertices = 4093; // not a multiple of any lane count
+
+    AMTM_Vertex        *vertices         = ArenaPush(temp.arena, AMTM_Vertex,        num_vertices);
+    AMTM_SkinnedVertex *skinned_vertices = ArenaPush(temp.arena, AMTM_SkinnedVertex, num_vertices);
+
+    F32 nan = VerifyNaN();
+
+    for (U32 it = 0; it < num_vertices; ++it) {
+        AMTM_SkinnedVertex *vertex = &skinned_vertices[it];
+
+        for (U32 c = 0; c < 3; ++c) {
+            vertex->position[c] = VerifyRandomF32(&state, -10.0f, 10.0f);
+            vertex->normal[c]   = VerifyRandomF32(&state, -1.5f, 1.5f);
+        }
+
+        vertex->uv[0] = VerifyRandomF32(&state, -0.5f, 1.5f);
+        vertex->uv[1] = VerifyRandomF32(&state, -0.5f, 1.5f);
+
+        vertex->material_index = VerifyRandomU32(&state);
+
+        U32 mode = it % 6;
+        for (U32 w = 0; w < 4; ++w) {
+            vertex->bone_indices[w] = cast(U8) VerifyRandomU32(&state);
+
+            switch (mode) {
+                case 0: { vertex->bone_weights[w] = 0.0f;                                        } break;
+                case 1: { vertex->bone_weights[w] = VerifyRandomF32(&state, -1.0f, 0.5f);        } break;
+                case 2: { vertex->bone_weights[w] = (w < 2) ? 0.375f : 0.125f;                   } break;
+                case 3: { vertex->bone_weights[w] = 0.25f;                                       } break;
+                case 4: { vertex->bone_weights[w] = VerifyRandomF32(&state, 0.0f, 1000000.0f);   } break;
+                case 5: { vertex->bone_weights[w] = VerifyRandomF32(&state, 0.0f, 1.0f);         } break;
+            }
+        }
+
+        if (mode == 5) {
+            F32 sum = ((vertex->bone_weights[0] + vertex->bone_weights[1]) + vertex->bone_weights[2]) + vertex->bone_weights[3];
+            for (U32 w = 0; w < 4; ++w) { vertex->bone_weights[w] /= sum; }
+        }
+
+        if ((it % 7) == 0) {
+            // a nan in one of the uvs, normals or weights
+            //
+            U32 which = VerifyRandomU32(&state) % 9;
+
+            if      (which < 2) { vertex->uv[which]               = nan; }
+            else if (which < 5) { vertex->normal[which - 2]       = nan; }
+            else                { vertex->bone_weights[which - 5] = nan; }
+        }
+
+        MemoryCopy(&vertices[it], vertex, sizeof(AMTM_Vertex));
+    }
+
+    R_Vertex3 *expected = ArenaPush(temp.arena, R_Vertex3, num_vertices);
+    R_Vertex3 *actual   = ArenaPush(temp.arena, R_Vertex3, num_vertices);
+
+    R_SkinnedVertex3 *skinned_expected = ArenaPush(temp.arena, R_SkinnedVertex3, num_vertices);
+    R_SkinnedVertex3 *skinned_actual   = ArenaPush(temp.arena, R_SkinnedVertex3, num_vertices);
+
+    for (U32 it = 0; it < num_vertices; ++it) {
+        VertexCook(&expected[it], &vertices[it]);
+        SkinnedVertexCook(&skinned_expected[it], &skinned_vertices[it]);
+    }
+
+    VerticesCook(actual, vertices, num_vertices);
+    SkinnedVerticesCook(skinned_actual, skinned_vertices, num_vertices);
+
+    U32 num_mismatched         = 0;
+    U32 num_skinned_mismatched = 0;
+    U32 num_bad_sums           = 0;
+
+    for (U32 it = 0; it < num_vertices; ++it) {
+        if (!MemoryCompare(&expected[it], &actual[it], sizeof(R_Vertex3))) { num_mismatched += 1; }
+
+        if (!MemoryCompare(&skinned_expected[it], &skinned_actual[it], sizeof(R_SkinnedVertex3))) {
+            num_skinned_mismatched += 1;
+        }
+
+        U8 *weights = skinned_actual[it].bone_weights;
+        U32 sum     = weights[0] + weights[1] + weights[2] + weights[3];
+
+        if (sum != 255) { num_bad_sums += 1; }
+    }
+
+    printf("Vertex cook:\n");
+    printf("    - %d lanes, %d vertices\n", WIDE_LANES, num_vertices);
+    printf("    - %d static vertices differ\n", num_mismatched);
+    printf("    - %d skinned vertices differ\n", num_skinned_mismatched);
+    printf("    - %d skinned vertices with weights that don't sum to 255\n", num_bad_sums);
+
+    if (num_mismatched != 0 || num_skinned_mismatched != 0 || num_bad_sums != 0) { result = false; }
+
+    TempRelease(&temp);
+
+    return result;
+}
+
+int main(int argc, char **argv) {
+    (void) argv;
+
+    if (argc != 1) {
+        printf("usage: verify\n");
+        return 1;
+    }
+
+    Arena *arena = ArenaAlloc(GB(64));
+
+    B32 passed = true;
+
+    passed = VerifyPoseLerp(arena)   && passed;
+    passed = VerifyVertexCook(arena) && passed;
+
+    printf("%s\n", passed ? "Passed" : "Failed");
+
+    int result = passed ? 0 : 1;
+    return result;
+}
@@ -27,7 +27,38 @@ from bpy_extras.io_utils import (axis_conversion)
 # Constants
 
 AMTS_MAGIC   = 0x53544D41 # 'AMTS'
-AMTS_VERSION = 1
+AMTS_VERSION = 4
+
+AMTS_CHANNEL_FORMAT_IDENTITY  = 0
+AMTS_CHANNEL_FORMAT_CONSTANT  = 1
+AMTS_CHANNEL_FORMAT_QUANTISED = 2
+AMTS_CHANNEL_FORMAT_SPARSE    = 3
+AMTS_CHANNEL_FORMAT_CURVE     = 4
+
+AMTS_CHANNEL_FORMAT_BITS = 4
+
+AMTS_TRACK_FLAG_CURVES             = 0x1
+AMTS_TRACK_FLAG_ADDITIVE           = 0x2
+AMTS_TRACK_FLAG_ADDITIVE_BIND_POSE = 0x4
+
+# Channels whose values stay within these tolerances of the first frame for the whole clip are stored as constants,
+# the orientation tolerance is compared against (1 - |dot(a, b)|)
+AMTS_POSITION_TOLERANCE    = 1e-5
+AMTS_ORIENTATION_TOLERANCE = 1e-7
+AMTS_SCALE_TOLERANCE       = 1e-5
+
+# Animated channels only keep the keys needed to stay within these tolerances when linearly interpolating between
+# them, if that is smaller than storing every frame
+AMTS_KEY_POSITION_TOLERANCE    = 1e-4
+AMTS_KEY_ORIENTATION_TOLERANCE = 1e-6
+AMTS_KEY_SCALE_TOLERANCE       = 1e-4
+
+AMTS_SMALLEST_THREE_RANGE = 0.70710678118
+
+TRACK_ENCODINGS = [
+    ("KEYS",   "Keys",   "Store animated channels as quantised or sparse keys", 1),
+    ("CURVES", "Curves", "Fit cubic hermite curves to the animated channels",    2)
+]
 
 AMTM_MAGIC   = 0x4D544D41 # 'AMTM'
 AMTM_VERSION = 1
@@ -78,17 +109,128 @@ class A_Track:
         self.num_frames  = num_frames
         self.samples     = samples
 
+        self.data        = b""
+        self.data_offset = 0
+
     def WriteInfo(self, file):
         U8Write(file,  self.flags)
         U8Write(file,  self.name_count)
         U16Write(file, self.name_offset)
         U32Write(file, self.num_frames)
 
-    def WriteSamples(self, file):
-        for sample in self.samples:
-            for p in sample.to_translation(): F32Write(file, p)
-            for o in sample.to_quaternion():  F32Write(file, o)
-            for s in sample.to_scale():       F32Write(file, s)
+    def Compress(self, num_bones):
+        positions    = [[] for b in range(num_bones)]
+        orientations = [[] for b in range(num_bones)]
+        scales       = [[] for b in range(num_bones)]
+
+        for f in range(self.num_frames):
+            for b in range(num_bones):
+                sample = self.samples[(f * num_bones) + b]
+
+                positions[b].append(tuple(sample.to_translation()))
+                orientations[b].append(tuple(sample.to_quaternion().normalized()))
+                scales[b].append(tuple(sample.to_scale()))
+
+        # Key frames are stored as 16-bit indices
+        assert self.num_frames <= 65536
+
+        use_curves = (self.flags & AMTS_TRACK_FLAG_CURVES) != 0
+
+        formats = []
+        keys    = []
+        for b in range(num_bones):
+            (p, p_keys) = A_ChannelFormatGet(positions[b],    (0.0, 0.0, 0.0),      AMTS_POSITION_TOLERANCE,    AMTS_KEY_POSITION_TOLERANCE,    False)
+            (o, o_keys) = A_ChannelFormatGet(orientations[b], (1.0, 0.0, 0.0, 0.0), AMTS_ORIENTATION_TOLERANCE, AMTS_KEY_ORIENTATION_TOLERANCE, True)
+            (s, s_keys) = A_ChannelFormatGet(scales[b],       (1.0, 1.0, 1.0),      AMTS_SCALE_TOLERANCE,       AMTS_KEY_SCALE_TOLERANCE,       False)
+
+            if use_curves:
+                # Every animated channel becomes a curve, the keys are chosen for the whole clip below
+                p = AMTS_CHANNEL_FORMAT_CURVE if p >= AMTS_CHANNEL_FORMAT_QUANTISED else p
+                o = AMTS_CHANNEL_FORMAT_CURVE if o >= AMTS_CHANNEL_FORMAT_QUANTISED else o
+                s = AMTS_CHANNEL_FORMAT_CURVE if s >= AMTS_CHANNEL_FORMAT_QUANTISED else s
+
+            formats.append((p, o, s))
+            keys.append((p_keys, o_keys, s_keys))
+
+        # Bounds only cover the quantised channels so constant channels don't waste any precision
+        animated = (AMTS_CHANNEL_FORMAT_QUANTISED, AMTS_CHANNEL_FORMAT_SPARSE)
+
+        self.position_min, self.position_extent = A_ChannelBoundsGet([positions[b] for b in range(num_bones) if formats[b][0] in animated])
+        self.scale_min,    self.scale_extent    = A_ChannelBoundsGet([scales[b]    for b in range(num_bones) if formats[b][2] in animated])
+
+        data = bytearray()
+
+        # Channel formats, padded to 4 bytes so the constants are aligned
+        for (p, o, s) in formats:
+            data += struct.pack("<H", p | (o << AMTS_CHANNEL_FORMAT_BITS) | (s << (2 * AMTS_CHANNEL_FORMAT_BITS)))
+
+        data += bytes((4 - (len(data) % 4)) % 4)
+
+        # Constant values
+        for b in range(num_bones):
+            for (channel_format, values) in zip(formats[b], (positions[b], orientations[b], scales[b])):
+                if channel_format == AMTS_CHANNEL_FORMAT_CONSTANT:
+                    data += struct.pack("<%df" % len(values[0]), *values[0])
+
+        # Quantised values, interleaved per frame
+        for f in range(self.num_frames):
+            for b in range(num_bones):
+                (p, o, s) = formats[b]
+
+                if p == AMTS_CHANNEL_FORMAT_QUANTISED:
+                    data += struct.pack("<3H", *A_RangeQuantise(positions[b][f], self.position_min, self.position_extent))
+
+                if o == AMTS_CHANNEL_FORMAT_QUANTISED:
+                    data += struct.pack("<3H", *A_SmallestThreeQuantise(orientations[b][f]))
+
+                if s == AMTS_CHANNEL_FORMAT_QUANTISED:
+                    data += struct.pack("<3H", *A_RangeQuantise(scales[b][f], self.scale_min, self.scale_extent))
+
+        # Sparse channels, key frames followed by the quantised value for each key
+        for b in range(num_bones):
+            (p, o, s) = formats[b]
+
+            if p == AMTS_CHANNEL_FORMAT_SPARSE:
+                data += A_SparseChannelPack(keys[b][0], [A_RangeQuantise(positions[b][k], self.position_min, self.position_extent) for k in keys[b][0]])
+
+            if o == AMTS_CHANNEL_FORMAT_SPARSE:
+                data += A_SparseChannelPack(keys[b][1], [A_SmallestThreeQuantise(orientations[b][k]) for k in keys[b][1]])
+
+            if s == AMTS_CHANNEL_FORMAT_SPARSE:
+                data += A_SparseChannelPack(keys[b][2], [A_RangeQuantise(scales[b][k], self.scale_min, self.scale_extent) for k in keys[b][2]])
+
+        # Curve channels, all of them share the same knots
+        curves = []
+        for b in range(num_bones):
+            for (channel_format, values, tolerance, is_orientation) in zip(formats[b], (positions[b], orientations[b], scales[b]),
+                    (AMTS_KEY_POSITION_TOLERANCE, AMTS_KEY_ORIENTATION_TOLERANCE, AMTS_KEY_SCALE_TOLERANCE), (False, True, False)):
+                if channel_format == AMTS_CHANNEL_FORMAT_CURVE:
+                    if is_orientation: values = A_QuaternionsAlign(values)
+                    curves.append(A_Curve(values, tolerance, is_orientation))
+
+        if len(curves) != 0:
+            knots = A_KnotsReduce(curves, self.num_frames)
+
+            data += bytes((4 - (len(data) % 4)) % 4)
+            data += struct.pack("<I", len(knots))
+
+            data += struct.pack("<%dH" % len(knots), *knots)
+            data += bytes(2 * (len(knots) % 2))
+
+            for k in knots:
+                for c in curves: data += struct.pack("<%df" % len(c.values[k]),   *c.values[k])
+                for c in curves: data += struct.pack("<%df" % len(c.tangents[k]), *c.tangents[k])
+
+        self.data = bytes(data)
+
+    def WriteClipInfo(self, file):
+        for v in self.position_min:    F32Write(file, v)
+        for v in self.position_extent: F32Write(file, v)
+        for v in self.scale_min:       F32Write(file, v)
+        for v in self.scale_extent:    F32Write(file, v)
+
+        U32Write(file, self.data_offset)
+        U32Write(file, len(self.data))
 
 # Mesh storage classes
 
@@ -183,6 +325,224 @@ def S32Write(file, value):
 def F32Write(file, value):
     file.write(struct.pack("<f", value))
 
+# Animation compression utilities
+
+def A_ValuesMatch(a, b, tolerance, is_orientation):
+    if is_orientation:
+        return (1.0 - abs(sum(x * y for (x, y) in zip(a, b)))) <= tolerance
+    else:
+        return max(abs(x - y) for (x, y) in zip(a, b)) <= tolerance
+
+def A_ValuesLerp(a, b, t, is_orientation):
+    if is_orientation and sum(x * y for (x, y) in zip(a, b)) < 0:
+        b = [-x for x in b]
+
+    result = [x + ((y - x) * t) for (x, y) in zip(a, b)]
+
+    if is_orientation:
+        length = sum(x * x for x in result) ** 0.5
+        result = [x / length for x in result]
+
+    return result
+
+# Removes keys which can be reconstructed within the tolerance by linearly interpolating the keys either side, the
+# segment with the largest error is split until all frames are within tolerance
+def A_KeysReduce(values, tolerance, is_orientation):
+    last = len(values) - 1
+    if last == 0: return [0]
+
+    result   = set([0, last])
+    segments = [(0, last)]
+
+    while len(segments) != 0:
+        (start, end) = segments.pop()
+
+        worst_frame = -1
+        worst_error = 0.0
+
+        for f in range(start + 1, end):
+            t = (f - start) / (end - start)
+            v = A_ValuesLerp(values[start], values[end], t, is_orientation)
+
+            if is_orientation:
+                error = 1.0 - abs(sum(x * y for (x, y) in zip(v, values[f])))
+            else:
+                error = max(abs(x - y) for (x, y) in zip(v, values[f]))
+
+            if error > worst_error:
+                worst_frame = f
+                worst_error = error
+
+        if worst_frame != -1 and worst_error > tolerance:
+            result.add(worst_frame)
+
+            segments.append((start, worst_frame))
+            segments.append((worst_frame, end))
+
+    return sorted(result)
+
+# Returns the format for the channel and the keys to store if the format is sparse
+def A_ChannelFormatGet(values, identity, tolerance, key_tolerance, is_orientation):
+    first = values[0]
+    if all(A_ValuesMatch(v, first, tolerance, is_orientation) for v in values):
+        if A_ValuesMatch(first, identity, tolerance, is_orientation):
+            return (AMTS_CHANNEL_FORMAT_IDENTITY, None)
+        else:
+            return (AMTS_CHANNEL_FORMAT_CONSTANT, None)
+
+    keys = A_KeysReduce(values, key_tolerance, is_orientation)
+
+    # Both store three 16-bit values, sparse also stores a 16-bit frame index for each key and a 4 byte header
+    dense_size  = 6 * len(values)
+    sparse_size = 4 + (8 * len(keys))
+
+    if sparse_size < dense_size:
+        return (AMTS_CHANNEL_FORMAT_SPARSE, keys)
+
+    return (AMTS_CHANNEL_FORMAT_QUANTISED, None)
+
+# Flips the sign of any quaternion which isn't in the same hemisphere as the one before it so the components are
+# continuous and can be fitted with a curve
+def A_QuaternionsAlign(values):
+    result = [values[0]]
+    for v in values[1:]:
+        if sum(x * y for (x, y) in zip(result[-1], v)) < 0:
+            v = tuple(-x for x in v)
+
+        result.append(v)
+
+    return result
+
+class A_Curve:
+    def __init__(self, values, tolerance, is_orientation):
+        self.values         = values
+        self.tolerance      = tolerance
+        self.is_orientation = is_orientation
+
+        # Tangents are per frame and use central differences, one sided at the ends of the clip
+        last = len(values) - 1
+
+        self.tangents = []
+        for f in range(len(values)):
+            a = values[max(f - 1, 0)]
+            b = values[min(f + 1, last)]
+
+            span = min(f + 1, last) - max(f - 1, 0)
+            self.tangents.append(tuple(((y - x) / span) if span > 0 else 0.0 for (x, y) in zip(a, b)))
+
+    def Evaluate(self, k0, k1, f):
+        length = k1 - k0
+        t      = (f - k0) / length
+
+        t2 = t * t
+        t3 = t2 * t
+
+        h00 = (2 * t3) - (3 * t2) + 1
+        h10 = (t3 - (2 * t2) + t) * length
+        h01 = (3 * t2) - (2 * t3)
+        h11 = (t3 - t2) * length
+
+        p0, m0 = self.values[k0], self.tangents[k0]
+        p1, m1 = self.values[k1], self.tangents[k1]
+
+        result = [(h00 * a) + (h10 * b) + (h01 * c) + (h11 * d) for (a, b, c, d) in zip(p0, m0, p1, m1)]
+
+        if self.is_orientation:
+            length = sum(x * x for x in result) ** 0.5
+            result = [x / length for x in result]
+
+        return result
+
+    def Error(self, k0, k1, f):
+        v = self.Evaluate(k0, k1, f)
+
+        if self.is_orientation:
+            error = 1.0 - abs(sum(x * y for (x, y) in zip(v, self.values[f])))
+        else:
+            error = max(abs(x - y) for (x, y) in zip(v, self.values[f]))
+
+        return error / self.tolerance
+
+# Finds the knots shared by all of the curves in a clip, the same as A_KeysReduce the segment with the largest error
+# is split until every curve is within its tolerance
+def A_KnotsReduce(curves, num_frames):
+    last = num_frames - 1
+    if last == 0: return [0]
+
+    result   = set([0, last])
+    segments = [(0, last)]
+
+    while len(segments) != 0:
+        (start, end) = segments.pop()
+
+        worst_frame = -1
+        worst_error = 0.0
+
+        for f in range(start + 1, end):
+            error = max(c.Error(start, end, f) for c in curves)
+
+            if error > worst_error:
+                worst_frame = f
+                worst_error = error
+
+        if worst_frame != -1 and worst_error > 1.0:
+            result.add(worst_frame)
+
+            segments.append((start, worst_frame))
+            segments.append((worst_frame, end))
+
+    return sorted(result)
+
+def A_SparseChannelPack(keys, values):
+    result = struct.pack("<HH", len(keys), 0)
+
+    result += struct.pack("<%dH" % len(keys), *keys)
+    for v in values:
+        result += struct.pack("<3H", *v)
+
+    return result
+
+def A_ChannelBoundsGet(channels):
+    lower  = [0.0, 0.0, 0.0]
+    extent = [0.0, 0.0, 0.0]
+
+    values = [v for c in channels for v in c]
+    if len(values) != 0:
+        for i in range(3):
+            lower[i]  = min(v[i] for v in values)
+            extent[i] = max(v[i] for v in values) - lower[i]
+
+    return (lower, extent)
+
+def A_RangeQuantise(value, lower, extent):
+    result = []
+    for i in range(3):
+        q = 0
+        if extent[i] > 0:
+            q = int(round(((value[i] - lower[i]) / extent[i]) * 65535))
+
+        result.append(max(0, min(q, 65535)))
+
+    return result
+
+# Drops the largest component of the quaternion and stores the other three in 15 bits each, the index of the
+# dropped component is stored in the top bit of the first two values
+def A_SmallestThreeQuantise(q):
+    largest = max(range(4), key = lambda i: abs(q[i]))
+    sign    = -1.0 if q[largest] < 0 else 1.0
+
+    result = []
+    for i in range(4):
+        if i == largest: continue
+
+        v = (((sign * q[i]) + AMTS_SMALLEST_THREE_RANGE) / (2 * AMTS_SMALLEST_THREE_RANGE)) * 32767
+        result.append(max(0, min(int(round(v)), 32767)))
+
+    result[0] |= (largest  & 1) << 15
+    result[1] |= (largest >> 1) << 15
+
+    return result
+
 # Other utilities
 
 def ArmatureListGet():
@@ -320,7 +680,32 @@ def A_BonesGet(bones, string_table, armature, axis_mapping_matrix):
         bone = A_Bone(bind_pose_matrix, inv_bind_pose_matrix, parent_index, name_count, name_offset)
         bones.append(bone)
 
-def A_TracksGet(tracks, string_table, armature, axis_mapping_matrix):
+# Parent relative bind pose of each bone, the same space the samples are stored in
+def A_LocalBindPosesGet(armature, axis_mapping_matrix):
+    result = []
+    for b in armature.data.bones:
+        if b.parent:
+            result.append(b.parent.matrix_local.inverted() @ b.matrix_local)
+        else:
+            result.append(axis_mapping_matrix @ b.matrix_local)
+
+    return result
+
+# Replaces each sample with its difference from the reference for the same bone, this matches what the runtime
+# expects for additive clips: position offset, conjugate(reference) * orientation and scale factor
+def A_SamplesDifferenceGet(samples, references):
+    num_bones = len(references)
+    for i in range(len(samples)):
+        (rp, rq, rs) = references[i % num_bones].decompose()
+        (p, q, s)    = samples[i].decompose()
+
+        position    = p - rp
+        orientation = (rq.conjugated() @ q).normalized()
+        scale       = mathutils.Vector((s.x / rs.x, s.y / rs.y, s.z / rs.z))
+
+        samples[i] = mathutils.Matrix.LocRotScale(position, orientation, scale)
+
+def A_TracksGet(tracks, string_table, armature, axis_mapping_matrix, track_encoding):
     # Count how much data is already in the string table from the bone names and use it as the starting offset
     string_table_offset = sum(map(len, string_table))
     for action in bpy.data.actions:
@@ -354,11 +739,25 @@ def A_TracksGet(tracks, string_table, armature, axis_mapping_matrix):
 
                 samples.append(pose_matrix)
 
-        # @incomplete: no flags yet
-        track = A_Track(0, name_count, name_offset, (end_frame - start_frame) + 1, samples)
+        # Actions can override the encoding chosen in the export properties with an 'amt_track_encoding' property
+        flags = 0
+        if action.get("amt_track_encoding", track_encoding) == "CURVES":
+            flags |= AMTS_TRACK_FLAG_CURVES
+
+        # Actions with an 'amt_additive' property of "FIRST_FRAME" or "BIND_POSE" are exported as the difference
+        # from that reference, this is done before compression so channels the clip doesn't change become identity
+        additive = action.get("amt_additive", "NONE")
+        if additive == "FIRST_FRAME":
+            A_SamplesDifferenceGet(samples, samples[0:len(armature.pose.bones)])
+            flags |= AMTS_TRACK_FLAG_ADDITIVE
+        elif additive == "BIND_POSE":
+            A_SamplesDifferenceGet(samples, A_LocalBindPosesGet(armature, axis_mapping_matrix))
+            flags |= (AMTS_TRACK_FLAG_ADDITIVE | AMTS_TRACK_FLAG_ADDITIVE_BIND_POSE)
+
+        track = A_Track(flags, name_count, name_offset, (end_frame - start_frame) + 1, samples)
         tracks.append(track)
 
-def A_SkeletonExport(output_dir):
+def A_SkeletonExport(output_dir, track_encoding):
     armatures = ArmatureListGet()
     if len(armatures) == 0:
         return { 'CANCELLED' }
@@ -380,7 +779,7 @@ def A_SkeletonExport(output_dir):
     string_table = []
 
     A_BonesGet(bones, string_table, armature, axis_mapping_matrix)
-    A_TracksGet(tracks, string_table, armature, axis_mapping_matrix)
+    A_TracksGet(tracks, string_table, armature, axis_mapping_matrix, track_encoding)
 
     # Pull the filename from the open .blend project so we can export under the same name
     filename = bpy.path.basename(bpy.data.filepath).split('.')[0]
@@ -408,10 +807,25 @@ def A_SkeletonExport(output_dir):
 
     U32Write(file_handle, bpy.context.scene.render.fps)
 
+    # Pad the string table so the clip data is aligned to 16 bytes and can be used directly from a file mapping.
+    # Header is 64 bytes, bone info 84 bytes, track info 8 bytes and clip info 56 bytes
+    clip_data_offset = 64 + sum(map(len, string_table)) + (84 * num_bones) + ((8 + 56) * num_tracks)
+    string_table.append(bytes((16 - (clip_data_offset % 16)) % 16))
+
     U32Write(file_handle, sum(map(len, string_table)))
 
+    # Compress all of the tracks up front so we know the size of the clip data
+    clip_data_size = 0
+    for t in tracks:
+        t.Compress(num_bones)
+
+        t.data_offset   = clip_data_size
+        clip_data_size += (len(t.data) + 3) & ~3
+
+    U32Write(file_handle, clip_data_size)
+
     # Pad the header to 64 bytes
-    for i in range(0, 9): U32Write(file_handle, 0)
+    for i in range(0, 8): U32Write(file_handle, 0)
 
     ### Header end
 
@@ -427,9 +841,14 @@ def A_SkeletonExport(output_dir):
     for t in tracks:
         t.WriteInfo(file_handle)
 
-    # Write animation track samples
+    # Write compressed clip information
     for t in tracks:
-        t.WriteSamples(file_handle)
+        t.WriteClipInfo(file_handle)
+
+    # Write compressed clip data, each clip is aligned to 4 bytes
+    for t in tracks:
+        file_handle.write(t.data)
+        file_handle.write(bytes((4 - (len(t.data) % 4)) % 4))
 
     bpy.context.scene.frame_set(base_frame)
     armature.animation_data.action = base_action
@@ -689,6 +1108,8 @@ class ExportProperties(bpy.types.PropertyGroup):
     up_axis:      bpy.props.EnumProperty(name = "Up", items = AXES, default = "Z")
     flip_uv:      bpy.props.BoolProperty(name = "Flip Textures", default = True)
 
+    track_encoding: bpy.props.EnumProperty(name = "Tracks", items = TRACK_ENCODINGS, default = "KEYS")
+
 class AmtExporter(bpy.types.Operator):
     bl_idname = "scene.amt_exporter"
     bl_label  = "Export"
@@ -708,7 +1129,7 @@ class AmtExporter(bpy.types.Operator):
         if not os.path.exists(output_dir): os.mkdir(output_dir)
 
         R_MeshExport(output_dir)
-        A_SkeletonExport(output_dir)
+        A_SkeletonExport(output_dir, context.scene.export_properties.track_encoding)
 
         return { 'FINISHED' }
 
@@ -725,6 +1146,7 @@ class ExportPanel(bpy.types.Panel):
         self.layout.prop(context.scene.export_properties, "forward_axis")
         self.layout.prop(context.scene.export_properties, "up_axis")
         self.layout.prop(context.scene.export_properties, "flip_uv")
+        self.layout.prop(context.scene.export_properties, "track_encoding")
         self.layout.operator("scene.amt_exporter")
 
 # Init and shutdown